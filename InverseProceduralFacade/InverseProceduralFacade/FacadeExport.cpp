@@ -0,0 +1,226 @@
+#include "FacadeExport.h"
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+
+FacadeExporter::FacadeExporter(const string& dataDir, shared_ptr<MeshCache> cache): dataDir(dataDir), cache(cache) {
+}
+
+string FacadeExporter::meshPath(const Facade& facade, const string& materialName) const {
+	auto materialSearch = facade.materialTable.find(materialName);
+	if (materialSearch == facade.materialTable.end()) {
+		return "";
+	}
+	string path = materialSearch->second;
+	if (ifstream(path).good()) {
+		return path;
+	}
+
+	// an absolute path from another machine: keep what follows material/
+	string relative = path;
+	replace(relative.begin(), relative.end(), '\\', '/');
+	size_t folder = relative.rfind("material/");
+	if (folder != string::npos) {
+		relative = relative.substr(folder + 9);
+	}
+	return dataDir + "material/" + relative;
+}
+
+bool FacadeExporter::loadMeshes(const Facade& facade) {
+	bool loaded = true;
+	for (auto& entry : facade.context->shapeTable) {
+		if (!cache->get(meshPath(facade, entry.first))) {
+			loaded = false;
+		}
+	}
+	return loaded;
+}
+
+// the names of the materials of facade, sorted so every export lists them alike
+static vector<string> sortedMaterials(const Facade& facade) {
+	vector<string> names;
+	for (auto& entry : facade.context->shapeTable) {
+		names.push_back(entry.first);
+	}
+	sort(names.begin(), names.end());
+	return names;
+}
+
+// true for each face of mesh whose corners all name a vertex, texture coordinate
+// and normal the mesh has; an OBJ index of 0 or past the end gives an id outside
+// them, and the exporter leaves such faces out
+static vector<bool> facesInRange(const PrimitiveMesh& mesh) {
+	vector<bool> inRange(mesh.faceSizes.size(), true);
+	size_t corner = 0;
+	for (size_t f = 0; f < mesh.faceSizes.size(); ++f) {
+		for (int c = 0; c < mesh.faceSizes[f]; ++c, ++corner) {
+			int v = mesh.positionIds[corner], t = mesh.texcoordIds[corner], n = mesh.normalIds[corner];
+			if (v < 0 || size_t(v) >= mesh.numVertices() || (t >= 0 && size_t(t) >= mesh.numTexcoords())
+				|| (n >= 0 && size_t(n) >= mesh.numNormals()) || t < -1 || n < -1) {
+				inRange[f] = false;
+			}
+		}
+	}
+	return inRange;
+}
+
+// appends the vertices, normals and faces of the shapes [first, last) to out.
+// The ids of the faces start after those of the shapes before first.
+static void formatShapes(const PrimitiveMesh& mesh, const vector<bool>& inRange, const vector<Shape>& shapes,
+	size_t first, size_t last, size_t vertexBase, size_t normalBase, size_t texcoordBase, string& out) {
+	char buf[128];
+	for (size_t s = first; s < last; ++s) {
+		const Shape& shape = shapes[s];
+		double scale[3] = { shape.scale[0], shape.scale[1], shape.scale[2] };
+		double position[3] = { shape.position[0], shape.position[1], shape.position[2] };
+		for (size_t i = 0; i < mesh.positions.size(); i += 3) {
+			snprintf(buf, sizeof(buf), "v %f %f %f\n",
+				position[0] + scale[0] * mesh.positions[i],
+				position[1] + scale[1] * mesh.positions[i + 1],
+				position[2] + scale[2] * mesh.positions[i + 2]);
+			out += buf;
+		}
+
+		// normals go through the inverse transpose of the scale, which is
+		// the scale of the other two axes
+		double normalScale[3] = { scale[1] * scale[2], scale[0] * scale[2], scale[0] * scale[1] };
+		for (size_t i = 0; i < mesh.normals.size(); i += 3) {
+			double n[3] = { normalScale[0] * mesh.normals[i], normalScale[1] * mesh.normals[i + 1], normalScale[2] * mesh.normals[i + 2] };
+			double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length > 0) {
+				snprintf(buf, sizeof(buf), "vn %f %f %f\n", n[0] / length, n[1] / length, n[2] / length);
+			}
+			else {
+				snprintf(buf, sizeof(buf), "vn %f %f %f\n", mesh.normals[i], mesh.normals[i + 1], mesh.normals[i + 2]);
+			}
+			out += buf;
+		}
+
+		size_t v = vertexBase + s * mesh.numVertices() + 1;
+		size_t vn = normalBase + s * mesh.numNormals() + 1;
+		size_t vt = texcoordBase + 1;
+		size_t corner = 0;
+		for (size_t f = 0; f < mesh.faceSizes.size(); ++f) {
+			if (!inRange[f]) {
+				corner += mesh.faceSizes[f];
+				continue;
+			}
+			out += "f";
+			for (int c = 0; c < mesh.faceSizes[f]; ++c, ++corner) {
+				int t = mesh.texcoordIds[corner], n = mesh.normalIds[corner];
+				if (t < 0 && n < 0) {
+					snprintf(buf, sizeof(buf), " %zu", v + mesh.positionIds[corner]);
+				}
+				else if (n < 0) {
+					snprintf(buf, sizeof(buf), " %zu/%zu", v + mesh.positionIds[corner], vt + t);
+				}
+				else if (t < 0) {
+					snprintf(buf, sizeof(buf), " %zu//%zu", v + mesh.positionIds[corner], vn + n);
+				}
+				else {
+					snprintf(buf, sizeof(buf), " %zu/%zu/%zu", v + mesh.positionIds[corner], vt + t, vn + n);
+				}
+				out += buf;
+			}
+			out += "\n";
+		}
+	}
+}
+
+bool FacadeExporter::writeObj(const Facade& facade, const string& filePath, unsigned threads) const {
+	ofstream file(filePath, ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	if (threads == 0) {
+		threads = max(1u, thread::hardware_concurrency());
+	}
+	file << "# facade " << facade.name << "\n";
+
+	size_t vertexBase = 0, normalBase = 0, texcoordBase = 0;
+	bool complete = true;
+	vector<string> materials = sortedMaterials(facade);
+	for (int m = 0; m < materials.size(); ++m) {
+		shared_ptr<const PrimitiveMesh> meshFound = cache->get(meshPath(facade, materials[m]));
+		if (!meshFound) {
+			// the shapes of this material are left out of the file
+			file << "# no mesh for " << materials[m] << "\n";
+			complete = false;
+			continue;
+		}
+		const PrimitiveMesh& mesh = *meshFound;
+		vector<bool> inRange = facesInRange(mesh);
+		const vector<Shape>& shapes = facade.context->shapeTable.find(materials[m])->second;
+
+		// the texture coordinates do not move with the shape: write them once
+		file << "g " << materials[m] << "\n";
+		char buf[64];
+		for (size_t i = 0; i < mesh.texcoords.size(); i += 2) {
+			snprintf(buf, sizeof(buf), "vt %f %f\n", mesh.texcoords[i], mesh.texcoords[i + 1]);
+			file << buf;
+		}
+
+		// the shapes go in chunks of about 64k vertices; each batch of
+		// chunks is formatted by the threads and written in order
+		size_t chunk = max(size_t(1), size_t(65536) / max(size_t(1), mesh.numVertices()));
+		size_t numChunks = (shapes.size() + chunk - 1) / chunk;
+		for (size_t batch = 0; batch < numChunks; batch += 4 * threads) {
+			size_t batchEnd = min(numChunks, batch + 4 * threads);
+			vector<string> texts(batchEnd - batch);
+			atomic<size_t> next(batch);
+			auto work = [&]() {
+				for (size_t c = next++; c < batchEnd; c = next++) {
+					formatShapes(mesh, inRange, shapes, c * chunk, min(shapes.size(), (c + 1) * chunk),
+						vertexBase, normalBase, texcoordBase, texts[c - batch]);
+				}
+			};
+			vector<thread> pool;
+			try {
+				for (unsigned t = 1; t < threads && t < texts.size(); ++t) {
+					pool.push_back(thread(work));
+				}
+			}
+			catch (const system_error&) {
+			}
+			work();
+			for (int i = 0; i < pool.size(); ++i) {
+				pool[i].join();
+			}
+			for (int i = 0; i < texts.size(); ++i) {
+				file << texts[i];
+			}
+		}
+
+		vertexBase += shapes.size() * mesh.numVertices();
+		normalBase += shapes.size() * mesh.numNormals();
+		texcoordBase += mesh.numTexcoords();
+	}
+	file.close();
+	return file.good() && complete;
+}
+
+bool FacadeExporter::writeInstances(const Facade& facade, const string& filePath) const {
+	ofstream file(filePath, ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	file << "# facade " << facade.name << "\n";
+
+	char buf[160];
+	vector<string> materials = sortedMaterials(facade);
+	for (int m = 0; m < materials.size(); ++m) {
+		const vector<Shape>& shapes = facade.context->shapeTable.find(materials[m])->second;
+		file << "prototype " << materials[m] << " " << shapes.size() << " " << meshPath(facade, materials[m]) << "\n";
+		for (int i = 0; i < shapes.size(); ++i) {
+			snprintf(buf, sizeof(buf), "%f %f %f %f %f %f\n",
+				shapes[i].position[0], shapes[i].position[1], shapes[i].position[2],
+				shapes[i].scale[0], shapes[i].scale[1], shapes[i].scale[2]);
+			file << buf;
+		}
+	}
+	file.close();
+	return file.good();
+}
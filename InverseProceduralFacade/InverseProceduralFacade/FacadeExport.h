@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ProceduralFacade.h"
+#include "PrimitiveMesh.h"
+
+// writes expanded facades without Maya.  Every terminal is the primitive mesh of
+// its material, a unit cube sized, scaled by Shape::scale and moved to
+// Shape::position, as the Maya instancer places it.
+class FacadeExporter {
+public:
+	string dataDir;
+	shared_ptr<MeshCache> cache;  // may be shared by the exporters of many facades
+
+	// the mesh file of a material; the paths in material/*.txt are tried as
+	// they are, then below the material folder of dataDir
+	string meshPath(const Facade& facade, const string& materialName) const;
+	// reads the meshes of every material of facade into the cache; false when
+	// one cannot be read.  Every export asks the cache again, so a mesh file
+	// that changed is read again.
+	bool loadMeshes(const Facade& facade);
+
+	// one OBJ with a group per material; threads > 1 transforms and formats
+	// the vertices in parallel, 0 uses every core.  Faces with a corner out of
+	// range are left out.  False when the file cannot be written or a
+	// material has no mesh; the file then notes the materials left out.
+	bool writeObj(const Facade& facade, const string& filePath, unsigned threads = 1) const;
+	// the meshes by reference and a position and a scale per shape:
+	//   prototype <material> <number of shapes> <mesh path>
+	//   <px> <py> <pz> <sx> <sy> <sz>      one line per shape
+	bool writeInstances(const Facade& facade, const string& filePath) const;
+
+	FacadeExporter(const string& dataDir = defaultDataDir, shared_ptr<MeshCache> cache = make_shared<MeshCache>());
+	~FacadeExporter() {}
+};
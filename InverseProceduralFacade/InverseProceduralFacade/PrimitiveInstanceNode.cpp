@@ -52,8 +52,8 @@ MStatus PrimitiveInstanceNode::compute(const MPlug& plug, MDataBlock& dataBlock)
 		MVectorArray instancesScaleArray = AAD.vectorArray("scale");
 		MDoubleArray instancesIdArray = AAD.doubleArray("id");
 
-		if (expandResultsTable.find(shapeName.asChar()) != expandResultsTable.end()) {
-			vector<Shape> shapeList = expandResultsTable.find(shapeName.asChar())->second;
+		if (context && context->shapeTable.find(shapeName.asChar()) != context->shapeTable.end()) {
+			const vector<Shape>& shapeList = context->shapeTable.find(shapeName.asChar())->second;
 
 			// create input arry to instancer node
 			for (int i = 0; i < shapeList.size(); ++i) {
@@ -66,7 +66,7 @@ MStatus PrimitiveInstanceNode::compute(const MPlug& plug, MDataBlock& dataBlock)
 			}
 		}
 		else {
-			MGlobal::displayInfo(MString("no corresponding shape founded in expandResultsTable"));
+			MGlobal::displayInfo(MString("no corresponding shape founded in the facade context"));
 		}
 
 		MDataHandle outputPointsHandle = dataBlock.outputValue(outPoints, &status);
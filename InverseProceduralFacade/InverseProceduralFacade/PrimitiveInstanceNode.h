@@ -25,6 +25,10 @@ public:
 
 	static MTypeId id;
 
+	// the facade this node reads its shapes from, set by the
+	// ProceduralFacadeCmd that created the node
+	shared_ptr<GenerationContext> context;
+
 	static MObject shapeName;
 	static MObject outPoints;
 
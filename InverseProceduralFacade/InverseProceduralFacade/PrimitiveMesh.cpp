@@ -0,0 +1,354 @@
+#include "PrimitiveMesh.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// a whole file to read: mapped where the system can, else copied into memory
+class MappedFile {
+public:
+	const char* data;
+	size_t size;
+
+	bool open(const string& filePath);
+
+	MappedFile(): data(nullptr), size(0), view(nullptr) {}
+	~MappedFile();
+
+private:
+	void* view;
+	string copy;
+};
+
+bool MappedFile::open(const string& filePath) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping != NULL) {
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+			size = size_t(fileSize.QuadPart);
+		}
+		CloseHandle(file);
+	}
+#else
+	int file = ::open(filePath.c_str(), O_RDONLY);
+	if (file >= 0) {
+		struct stat st;
+		if (fstat(file, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+			void* mapped = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (mapped != MAP_FAILED) {
+				madvise(mapped, size_t(st.st_size), MADV_SEQUENTIAL);
+				view = mapped;
+			}
+			size = size_t(st.st_size);
+		}
+		close(file);
+	}
+#endif
+	if (view != nullptr) {
+		data = static_cast<const char*>(view);
+		return true;
+	}
+
+	// empty files and files that cannot be mapped
+	ifstream in(filePath, ios::binary);
+	if (!in.is_open()) {
+		return false;
+	}
+	stringstream buffer;
+	buffer << in.rdbuf();
+	copy = buffer.str();
+	data = copy.data();
+	size = copy.size();
+	return true;
+}
+
+MappedFile::~MappedFile() {
+	if (view != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(view);
+#else
+		munmap(view, size);
+#endif
+	}
+}
+
+static bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipBlanks(const char* p, const char* end) {
+	while (p < end && isBlank(*p)) {
+		++p;
+	}
+	return p;
+}
+
+static bool isDigit(const char* p, const char* end) {
+	return p < end && *p >= '0' && *p <= '9';
+}
+
+// reads a number such as -0.375000 or 1e-3.  Below 2^24 significant units and
+// with powers of ten up to 10^10 both are exact floats, so the one float multiply
+// or divide rounds correctly; other numbers go to strtof.
+static bool parseFloat(const char*& p, const char* end, float& value) {
+	static const float powersOf10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	p = skipBlanks(p, end);
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+
+	unsigned long long mantissa = 0;
+	int exponent = 0;
+	bool anyDigit = false;
+	for (; isDigit(p, end); ++p) {
+		anyDigit = true;
+		if (mantissa < 100000000000000000ULL) {
+			mantissa = mantissa * 10 + (*p - '0');
+		}
+		else {
+			++exponent;
+		}
+	}
+	if (p < end && *p == '.') {
+		for (++p; isDigit(p, end); ++p) {
+			anyDigit = true;
+			if (mantissa < 100000000000000000ULL) {
+				mantissa = mantissa * 10 + (*p - '0');
+				--exponent;
+			}
+		}
+	}
+	if (!anyDigit) {
+		p = start;
+		return false;
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = *e == '-';
+			++e;
+		}
+		if (isDigit(e, end)) {
+			int written = 0;
+			for (; isDigit(e, end); ++e) {
+				if (written < 10000) {
+					written = written * 10 + (*e - '0');
+				}
+			}
+			exponent += negativeExponent ? -written : written;
+			p = e;
+		}
+	}
+
+	if (mantissa < (1ULL << 24) && exponent >= -10 && exponent <= 10) {
+		float v = exponent < 0 ? float(mantissa) / powersOf10[-exponent] : float(mantissa) * powersOf10[exponent];
+		value = negative ? -v : v;
+		return true;
+	}
+	char text[64];
+	size_t length = size_t(p - start);
+	if (length >= sizeof(text)) {
+		return false;
+	}
+	memcpy(text, start, length);
+	text[length] = 0;
+	value = strtof(text, nullptr);
+	return true;
+}
+
+// reads an OBJ index, counted from 1 or from the end when negative, as an id from 0
+static bool parseIndex(const char*& p, const char* end, size_t count, int& id) {
+	bool negative = false;
+	if (p < end && *p == '-') {
+		negative = true;
+		++p;
+	}
+	if (!isDigit(p, end)) {
+		return false;
+	}
+	long long index = 0;
+	for (; isDigit(p, end); ++p) {
+		index = index * 10 + (*p - '0');
+	}
+	id = negative ? int((long long)count - index) : int(index - 1);
+	return true;
+}
+
+bool PrimitiveMesh::loadFromFile(const string& filePath) {
+	MappedFile file;
+	if (!file.open(filePath)) {
+		return false;
+	}
+	return loadFromText(file.data, file.data + file.size);
+}
+
+bool PrimitiveMesh::loadFromText(const char* begin, const char* end) {
+	positions.clear();
+	normals.clear();
+	texcoords.clear();
+	faceSizes.clear();
+	positionIds.clear();
+	normalIds.clear();
+	texcoordIds.clear();
+
+	const char* p = begin;
+	while (p < end) {
+		p = skipBlanks(p, end);
+		if (p + 1 < end && p[0] == 'v' && isBlank(p[1])) {
+			float xyz[3] = { 0, 0, 0 };
+			p += 1;
+			for (int i = 0; i < 3 && parseFloat(p, end, xyz[i]); ++i) {}
+			positions.insert(positions.end(), xyz, xyz + 3);
+		}
+		else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && isBlank(p[2])) {
+			float xyz[3] = { 0, 0, 0 };
+			p += 2;
+			for (int i = 0; i < 3 && parseFloat(p, end, xyz[i]); ++i) {}
+			normals.insert(normals.end(), xyz, xyz + 3);
+		}
+		else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+			float uv[2] = { 0, 0 };
+			p += 2;
+			for (int i = 0; i < 2 && parseFloat(p, end, uv[i]); ++i) {}
+			texcoords.insert(texcoords.end(), uv, uv + 2);
+		}
+		else if (p + 1 < end && p[0] == 'f' && isBlank(p[1])) {
+			// each corner is v, v/vt, v//vn or v/vt/vn
+			p += 1;
+			int size = 0;
+			for (p = skipBlanks(p, end); p < end && *p != '\n'; p = skipBlanks(p, end)) {
+				int v = 0, vt = -1, vn = -1;
+				if (!parseIndex(p, end, numVertices(), v)) {
+					break;
+				}
+				if (p < end && *p == '/') {
+					++p;
+					parseIndex(p, end, numTexcoords(), vt);
+					if (p < end && *p == '/') {
+						++p;
+						parseIndex(p, end, numNormals(), vn);
+					}
+				}
+				positionIds.push_back(v);
+				texcoordIds.push_back(vt);
+				normalIds.push_back(vn);
+				++size;
+			}
+			faceSizes.push_back(size);
+		}
+		// the rest of the line: comments, groups, materials and smoothing
+		const char* newline = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+		p = newline == nullptr ? end : newline + 1;
+	}
+	pack();
+	return true;
+}
+
+namespace {
+	struct Corner {
+		int position, texcoord, normal;
+		bool operator==(const Corner& o) const { return position == o.position && texcoord == o.texcoord && normal == o.normal; }
+	};
+	struct CornerHash {
+		size_t operator()(const Corner& c) const {
+			return size_t(c.position) * 73856093u ^ size_t(c.texcoord) * 19349663u ^ size_t(c.normal) * 83492791u;
+		}
+	};
+}
+
+void PrimitiveMesh::pack() {
+	packedVertices.clear();
+	packedIndices.clear();
+	packedIndices.reserve(positionIds.size() * 3);
+
+	unordered_map<Corner, unsigned, CornerHash> packedIds;
+	vector<unsigned> cornerIds(positionIds.size());
+	for (size_t c = 0; c < positionIds.size(); ++c) {
+		Corner corner = { positionIds[c], texcoordIds[c], normalIds[c] };
+		auto found = packedIds.find(corner);
+		if (found != packedIds.end()) {
+			cornerIds[c] = found->second;
+			continue;
+		}
+		float vertex[packedStride] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		if (corner.position >= 0 && corner.position < int(numVertices())) {
+			memcpy(vertex, &positions[corner.position * 3], 3 * sizeof(float));
+		}
+		if (corner.normal >= 0 && corner.normal < int(numNormals())) {
+			memcpy(vertex + 3, &normals[corner.normal * 3], 3 * sizeof(float));
+		}
+		if (corner.texcoord >= 0 && corner.texcoord < int(numTexcoords())) {
+			memcpy(vertex + 6, &texcoords[corner.texcoord * 2], 2 * sizeof(float));
+		}
+		cornerIds[c] = unsigned(packedIds.size());
+		packedIds.insert({ corner, cornerIds[c] });
+		packedVertices.insert(packedVertices.end(), vertex, vertex + packedStride);
+	}
+
+	// faces become fans of triangles around their first corner
+	size_t first = 0;
+	for (size_t f = 0; f < faceSizes.size(); ++f) {
+		for (int i = 1; i + 1 < faceSizes[f]; ++i) {
+			packedIndices.push_back(cornerIds[first]);
+			packedIndices.push_back(cornerIds[first + i]);
+			packedIndices.push_back(cornerIds[first + i + 1]);
+		}
+		first += faceSizes[f];
+	}
+}
+
+shared_ptr<const PrimitiveMesh> MeshCache::get(const string& filePath) {
+	struct stat st;
+	if (stat(filePath.c_str(), &st) != 0) {
+		return nullptr;
+	}
+	{
+		lock_guard<mutex> guard(lock);
+		auto found = entries.find(filePath);
+		if (found != entries.end() && found->second.modified == (long long)st.st_mtime && found->second.fileSize == (long long)st.st_size) {
+			return found->second.mesh;
+		}
+	}
+
+	// read without the lock, so other meshes can be read at the same time
+	shared_ptr<PrimitiveMesh> mesh = make_shared<PrimitiveMesh>();
+	if (!mesh->loadFromFile(filePath)) {
+		return nullptr;
+	}
+	Entry entry = { (long long)st.st_mtime, (long long)st.st_size, mesh };
+	lock_guard<mutex> guard(lock);
+	entries[filePath] = entry;
+	return mesh;
+}
+
+size_t MeshCache::size() const {
+	lock_guard<mutex> guard(lock);
+	return entries.size();
+}
+
+void MeshCache::clear() {
+	lock_guard<mutex> guard(lock);
+	entries.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+// a primitive mesh read from an OBJ file.  The ids of a face corner count from 0;
+// a corner without a normal or texture coordinate has -1.
+class PrimitiveMesh {
+public:
+	vector<float> positions;   // x y z of each vertex
+	vector<float> normals;     // x y z of each normal
+	vector<float> texcoords;   // u v of each texture coordinate
+	vector<int> faceSizes;     // the number of corners of each face
+	vector<int> positionIds;   // per corner
+	vector<int> normalIds;
+	vector<int> texcoordIds;
+
+	// the mesh ready to draw: one vertex for each distinct position, texture
+	// coordinate and normal a corner uses, and the faces cut into triangles
+	static const int packedStride = 8;  // x y z nx ny nz u v
+	vector<float> packedVertices;
+	vector<unsigned> packedIndices;
+
+	// replace the mesh with the one read from the file, through a memory map
+	// where the system has one, or from the text [begin, end)
+	bool loadFromFile(const string& filePath);
+	bool loadFromText(const char* begin, const char* end);
+	void pack();
+
+	size_t numVertices() const { return positions.size() / 3; }
+	size_t numNormals() const { return normals.size() / 3; }
+	size_t numTexcoords() const { return texcoords.size() / 2; }
+};
+
+// meshes read once and shared: a mesh is read again only when its file has
+// another modification time or size.  Safe to use from several threads.
+class MeshCache {
+public:
+	// the mesh of filePath, nullptr when it cannot be read
+	shared_ptr<const PrimitiveMesh> get(const string& filePath);
+	size_t size() const;
+	void clear();
+
+	MeshCache() {}
+	~MeshCache() {}
+
+private:
+	struct Entry {
+		long long modified;
+		long long fileSize;
+		shared_ptr<const PrimitiveMesh> mesh;
+	};
+	mutable mutex lock;
+	unordered_map<string, Entry> entries;  // key: mesh path
+};
@@ -1,9 +1,12 @@
 #include "ProceduralFacadeCmd.h"
+#include "PrimitiveInstanceNode.h"
 
 
 #include <maya/MGlobal.h>
 #include <maya/MSyntax.h>
 #include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MFnDependencyNode.h>
 #include <list>
 
 const char *facadeNameFlag = "-n", *facadeNameLongFlag = "-facadeName";
@@ -55,8 +58,8 @@ MStatus ProceduralFacadeCmd::doIt( const MArgList& args )
 	// using MEL to create Instancer nodes and connet them
 	MString MELCommand;
 	int id = 1;
-	MGlobal::displayInfo("resultTable length:" + expandResultsTable.size());
-	for (auto entry : expandResultsTable) {
+	MGlobal::displayInfo(MString("resultTable length: ") + (int)facade.context->shapeTable.size());
+	for (auto entry : facade.context->shapeTable) {
 		string shapeName = entry.first;
 		string shapePath;
 		if (facade.materialTable.find(shapeName) != facade.materialTable.end()) {
@@ -65,10 +68,22 @@ MStatus ProceduralFacadeCmd::doIt( const MArgList& args )
 		MGlobal::displayInfo("shapeName:" + MString(shapeName.c_str()) + "shapePath: " + MString(shapePath.c_str()) + ", id:" + id);
 
 
-		// create nodes
-		MELCommand = MString("createNode PrimitiveInstanceNode;\n")
-			+ MString("setAttr -type \"string\" \"PrimitiveInstanceNode") + id + MString(".shapeName\" ") + MString(shapeName.c_str()) + MString(";")
-			+ MString("instancer;\n")
+		// create nodes; each node keeps the context of this facade, so the
+		// nodes of earlier facades still read their own shapes
+		MString nodeName;
+		MGlobal::executeCommand("createNode PrimitiveInstanceNode;", nodeName);
+		MSelectionList nodeList;
+		MObject nodeObject;
+		if (nodeList.add(nodeName) == MS::kSuccess && nodeList.getDependNode(0, nodeObject) == MS::kSuccess) {
+			PrimitiveInstanceNode* node = dynamic_cast<PrimitiveInstanceNode*>(MFnDependencyNode(nodeObject).userNode());
+			if (node) {
+				node->context = facade.context;
+			}
+		}
+		MString instancerName;
+		MGlobal::executeCommand("instancer;", instancerName);
+
+		MELCommand = MString("setAttr -type \"string\" \"") + nodeName + MString(".shapeName\" ") + MString(shapeName.c_str()) + MString(";\n")
 
 			// load primitive obj
 			+ MString("$nodes = `file -import -type \"OBJ\" -rnn -ignoreVersion -ra true -mergeNamespacesOnClash false -options \"mo = 1\"  -pr \"") + MString(shapePath.c_str()) + MString("\"`;")
@@ -76,8 +91,8 @@ MStatus ProceduralFacadeCmd::doIt( const MArgList& args )
 			+ MString("rename ") + MString(shapeName.c_str()) + MString(";")
 			+ MString("hide;")
 
-			+ MString("connectAttr ") + MString(shapeName.c_str()) + MString(".matrix ") + MString("instancer") + id + MString(".inputHierarchy[0];\n")
-			+ MString("connectAttr PrimitiveInstanceNode") + id + MString(".outPoints ") + MString("instancer") + id + MString(".inputPoints;\n");
+			+ MString("connectAttr ") + MString(shapeName.c_str()) + MString(".matrix ") + instancerName + MString(".inputHierarchy[0];\n")
+			+ MString("connectAttr ") + nodeName + MString(".outPoints ") + instancerName + MString(".inputPoints;\n");
 		MGlobal::executeCommand(MELCommand);
 
 		//MELCommand = MString("$nodes = `file -import -type \"OBJ\" -rnn -ignoreVersion -ra true -mergeNamespacesOnClash false -options \"mo = 1\"  -pr \"") + MString(shapePath.c_str()) + MString("\"`;");
@@ -1,9 +1,11 @@
 #include "ProceduralFacade.h"
 #include <fstream>
 #include <sstream>
-
-unordered_map<string, vector<Shape>> expandResultsTable;
-unordered_map<string, Rule> finalRuleTable;
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
 
 Shape::Shape(const string& name, bool isTerminal, vec3 size, vec3 posistion) : name(name), isTerminal(isTerminal), size(size), position(posistion) {
 	if (isTerminal) {
@@ -12,14 +14,16 @@ Shape::Shape(const string& name, bool isTerminal, vec3 size, vec3 posistion) : n
 	}
 }
 
-Facade::Facade(const string& facadeName, const vec3& defualtSize): name(facadeName), 
+const string defaultDataDir = "E:\\CGGT\\CIS660\\Authoring_tool\\MayaPlugin\\CIS660-Authoring-Tool\\InverseProceduralFacade\\InverseProceduralFacade\\"; // place holder for now
+
+Facade::Facade(const string& facadeName, const vec3& defualtSize, const string& dataDir): name(facadeName), 
+																	dataDir(dataDir),
+																	context(make_shared<GenerationContext>()),
+																	grammar(facadeName, context, dataDir),
 																	axiom(Shape("building", false, defualtSize, vec3(0, 0, 0))) {
-	
-	// load grammar from file
-	grammar = Grammar(facadeName);
 
 	// load materials data
-	string materialsFilePath = "E:\\CGGT\\CIS660\\Authoring_tool\\MayaPlugin\\CIS660-Authoring-Tool\\InverseProceduralFacade\\InverseProceduralFacade\\material\\" + facadeName + ".txt"; // place holder for now
+	string materialsFilePath = dataDir + "material/" + facadeName + ".txt";
 	loadMaterialsFromFile(materialsFilePath);
 
 }
@@ -49,29 +53,161 @@ void Facade::loadMaterialsFromFile(const string& filePath) {
 	file.close();
 }
 
-void Facade::expand() {
+// a terminal shape and how many rules below the root of its subtree it was made
+typedef pair<int, Shape> DepthShape;
+
+// the number of terminals below shape
+static size_t countSubtree(const Shape& shape, const GenerationContext& context) {
+	unordered_map<string, MaterialStats> stats;
+	const Rule* rule = context.findRule(shape.name);
+	if (rule != nullptr) {
+		rule->addStatistics(shape, context, 1, stats);
+	}
+	size_t total = 0;
+	for (auto& entry : stats) {
+		total += entry.second.count;
+	}
+	return total;
+}
+
+// expands the subtree below root breadth first, as Facade::expand does, keeping
+// the terminals in the order they are made
+static void expandSubtree(const Shape& root, const GenerationContext& context, vector<DepthShape>& terminals) {
+	terminals.reserve(countSubtree(root, context));
+
+	queue<DepthShape> queue;
+	queue.push(DepthShape(0, root));
+
+	while (queue.size() > 0) {
+		DepthShape curr = queue.front();
+		queue.pop();
+
+		const Rule* rule = context.findRule(curr.second.name);
+		if (rule != nullptr) {
+			vector<Shape> succsesors = rule->applyTo(curr.second, context);
+			for (int i = 0; i < succsesors.size(); ++i) {
+				if (succsesors[i].isTerminal) {
+					terminals.push_back(DepthShape(curr.first + 1, succsesors[i]));
+				}
+				else {
+					queue.push(DepthShape(curr.first + 1, succsesors[i]));
+				}
+			}
+		}
+	}
+}
+
+unordered_map<string, size_t> Facade::countTerminals() const {
+	unordered_map<string, size_t> counts;
+	unordered_map<string, MaterialStats> stats = statistics();
+	for (auto& entry : stats) {
+		counts[entry.first] = entry.second.count;
+	}
+	return counts;
+}
+
+unordered_map<string, MaterialStats> Facade::statistics() const {
+	return grammar.statistics(axiom.size, axiom.name);
+}
+
+void Facade::expand(unsigned threads) {
+	// size every list for the shapes it will hold, so adding them never
+	// reallocates
+	context->shapeTable.clear();
+	unordered_map<string, size_t> counts = countTerminals();
+	for (auto& entry : counts) {
+		context->shapeTable[entry.first].reserve(entry.second);
+	}
+	if (threads == 0) {
+		threads = max(1u, thread::hardware_concurrency());
+	}
+	if (threads > 1) {
+		// expand whole levels until there are a few subtrees for every thread
+		vector<Shape> frontier(1, axiom);
+		while (frontier.size() > 0 && frontier.size() < 4 * threads) {
+			vector<Shape> below;
+			for (int i = 0; i < frontier.size(); ++i) {
+				const Rule* rule = context->findRule(frontier[i].name);
+				if (rule == nullptr) {
+					continue;
+				}
+				vector<Shape> succsesors = rule->applyTo(frontier[i], *context);
+				for (int j = 0; j < succsesors.size(); ++j) {
+					if (succsesors[j].isTerminal) {
+						context->addTerminal(succsesors[j]);
+					}
+					else {
+						below.push_back(succsesors[j]);
+					}
+				}
+			}
+			frontier.swap(below);
+		}
+
+		// the threads take the next subtree until none is left
+		vector<vector<DepthShape>> terminals(frontier.size());
+		vector<exception_ptr> errors(frontier.size());
+		atomic<size_t> next(0);
+		const GenerationContext& rules = *context;
+		auto work = [&frontier, &terminals, &errors, &next, &rules]() {
+			for (size_t i = next++; i < frontier.size(); i = next++) {
+				try {
+					expandSubtree(frontier[i], rules, terminals[i]);
+				}
+				catch (...) {
+					errors[i] = current_exception();
+				}
+			}
+		};
+		vector<thread> pool;
+		try {
+			for (unsigned t = 1; t < threads && t < frontier.size(); ++t) {
+				pool.push_back(thread(work));
+			}
+		}
+		catch (const system_error&) {
+		}
+		work();
+		for (int i = 0; i < pool.size(); ++i) {
+			pool[i].join();
+		}
+		for (int i = 0; i < errors.size(); ++i) {
+			if (errors[i]) {
+				rethrow_exception(errors[i]);
+			}
+		}
+
+		// a breadth first expand makes every shape of a level before the next
+		// one, so merging the subtrees level by level gives its order
+		vector<size_t> taken(frontier.size(), 0);
+		size_t left = 0;
+		for (int i = 0; i < terminals.size(); ++i) {
+			left += terminals[i].size();
+		}
+		for (int depth = 1; left > 0; ++depth) {
+			for (int i = 0; i < terminals.size(); ++i) {
+				for (; taken[i] < terminals[i].size() && terminals[i][taken[i]].first == depth; ++taken[i], --left) {
+					context->addTerminal(terminals[i][taken[i]].second);
+				}
+			}
+		}
+		return;
+	}
+
+	queue<Shape> queue;
 	queue.push(axiom);
 	
 	while (queue.size() > 0) {
 		Shape currShape = queue.front();
 		queue.pop();
 
-		auto ruleSearch = grammar.ruleTable.find(currShape.name);
-		if (ruleSearch != grammar.ruleTable.end()) {
-			Rule rule = ruleSearch->second;
-			vector<Shape> succsesors = rule.applyTo(currShape);
+		const Rule* rule = context->findRule(currShape.name);
+		if (rule != nullptr) {
+			vector<Shape> succsesors = rule->applyTo(currShape, *context);
 			for (int i = 0; i < succsesors.size(); ++i) {
 				Shape succsesor = succsesors[i];
 				if (succsesor.isTerminal) {  // add terminal shapes to final result table
-					if (shapeTable.find(succsesor.name) == shapeTable.end()) {
-						vector<Shape> shapeList;
-						shapeList.push_back(succsesor);
-						shapeTable.insert({ succsesor.name, shapeList });
-					}
-					else {
-						shapeTable.find(succsesor.name)->second.push_back(succsesor);
-
-					}
+					context->addTerminal(succsesor);
 				}
 				else {                      // add non-terminal shape to the queue
 					queue.push(succsesor);
@@ -79,16 +215,25 @@ void Facade::expand() {
 			}
 		}
 	}
+}
+
+const Rule* GenerationContext::findRule(const string& shapeName) const {
+	auto ruleSearch = ruleTable.find(shapeName);
+	if (ruleSearch != ruleTable.end()) {
+		return &ruleSearch->second;
+	}
+	return nullptr;
+}
 
-	expandResultsTable = unordered_map<string, vector<Shape>>(shapeTable);
+void GenerationContext::addTerminal(const Shape& shape) {
+	shapeTable[shape.name].push_back(shape);
 }
 
-Grammar::Grammar(const string& facadeName): name(facadeName) {
+Grammar::Grammar(const string& facadeName, shared_ptr<GenerationContext> context, const string& dataDir): name(facadeName), context(context) {
 	// parse grammar file
 	//string filePath = "./grammar/" + facadeName + ".txt";
-	string filePath = "E:\\CGGT\\CIS660\\Authoring_tool\\MayaPlugin\\CIS660-Authoring-Tool\\InverseProceduralFacade\\InverseProceduralFacade\\grammar\\" + facadeName + ".txt";
+	string filePath = dataDir + "grammar/" + facadeName + ".txt";
 	parseGrammarFromFile(filePath);
-	finalRuleTable = unordered_map<string, Rule>(ruleTable);
 }
 
 void Grammar::parseGrammarFromFile(const string& filePath) {
@@ -141,14 +286,23 @@ void Grammar::addRule(string line) {
 		rule.addChild(shape);
 	}
 
-	ruleTable.insert({ predesessor, rule });
+	context->ruleTable.insert({ predesessor, rule });
 }
 
 Rule Grammar::getRuleByShape(const Shape& shape) {
-	auto ruleSearch = ruleTable.find(shape.name);
-	if (ruleSearch != ruleTable.end()) {
-		return ruleSearch->second;
+	const Rule* rule = context->findRule(shape.name);
+	if (rule != nullptr) {
+		return *rule;
+	}
+}
+
+unordered_map<string, MaterialStats> Grammar::statistics(const vec3& size, const string& axiomName) const {
+	unordered_map<string, MaterialStats> stats;
+	const Rule* rule = context->findRule(axiomName);
+	if (rule != nullptr) {
+		rule->addStatistics(Shape(axiomName, false, size, vec3(0, 0, 0)), *context, 1, stats);
 	}
+	return stats;
 }
 
 Rule::Rule(const string& pred, int axisId, int ruleType, int numChildren): predecessor(pred), numOfChildren(numOfChildren){
@@ -170,21 +324,21 @@ void Rule::addChild(Shape& child) {
 	children.push_back(child);
 }
 
-vector<Shape> Rule::applyTo(const Shape& shape) {
+vector<Shape> Rule::applyTo(const Shape& shape, const GenerationContext& context) const {
 	switch (type) {
 	case split:
-		return splitRule(shape, axis);
+		return splitRule(shape, axis, context);
 	case repeat:
-		return repeatRule(shape, axis);
+		return repeatRule(shape, axis, context);
 	default:
 		break;
 	}
 }
 
-vector<Shape> Rule::splitRule(const Shape& pred, AXIS axis) {
+vector<Shape> Rule::splitRule(const Shape& pred, AXIS axis, const GenerationContext& context) const {
 	vector<Shape> successors;
 
-	vector<float> ratios = calcSplitRatio(pred, children, axis);
+	vector<float> ratios = calcSplitRatio(pred, children, axis, context);
 
 	vec3 accumulate_pos = vec3(pred.position);
 	accumulate_pos[axis] -= pred.size[axis] / 2;
@@ -203,10 +357,10 @@ vector<Shape> Rule::splitRule(const Shape& pred, AXIS axis) {
 	return successors;
 }
 
-vector<Shape> Rule::repeatRule(const Shape& pred, AXIS axis) {
+vector<Shape> Rule::repeatRule(const Shape& pred, AXIS axis, const GenerationContext& context) const {
 	vector<Shape> successors;
 
-	vector<float> splitRatios = calcSplitRatio(pred, children, axis);
+	vector<float> splitRatios = calcSplitRatio(pred, children, axis, context);
 	int repeatTimes = calcRepeatTimes(pred, children, axis);
 
 	vec3 singleRepeatSize = vec3(pred.size);
@@ -232,7 +386,7 @@ vector<Shape> Rule::repeatRule(const Shape& pred, AXIS axis) {
 	return successors;
 }
 
-vector<float> Rule::calcSplitRatio(const Shape& pred, const vector<Shape>& children, AXIS axis) {
+vector<float> Rule::calcSplitRatio(const Shape& pred, const vector<Shape>& children, AXIS axis, const GenerationContext& context) const {
 	vector<float> ratios;
 
 	// check if any children shape has repeat rule
@@ -243,8 +397,8 @@ vector<float> Rule::calcSplitRatio(const Shape& pred, const vector<Shape>& child
 	for (int i = 0; i < children.size(); ++i) {
 		children_sizes += children[i].size[axis];
 
-		auto ruleSearch = finalRuleTable.find(children[i].name);
-		if (ruleSearch != finalRuleTable.end() && ruleSearch->second.type == repeat) {
+		const Rule* rule = context.findRule(children[i].name);
+		if (rule != nullptr && rule->type == repeat) {
 			hasRepeat = true;
 			repeat_sizes += children[i].size[axis];
 		}
@@ -261,8 +415,8 @@ vector<float> Rule::calcSplitRatio(const Shape& pred, const vector<Shape>& child
 
 	if (hasRepeat) {
 		for (int i = 0; i < children.size(); ++i) {
-			auto ruleSearch = finalRuleTable.find(children[i].name);
-			if (ruleSearch != finalRuleTable.end() && ruleSearch->second.type == repeat) {
+			const Rule* rule = context.findRule(children[i].name);
+			if (rule != nullptr && rule->type == repeat) {
 				float repeat_ratio = children[i].size[axis] / repeat_sizes;
 				float newSize = repeat_ratio * repeat_region_size;
 				ratios.push_back(newSize / pred.size[axis]);
@@ -287,7 +441,7 @@ vector<float> Rule::calcSplitRatio(const Shape& pred, const vector<Shape>& child
 	return ratios;
 }
 
-int Rule::calcRepeatTimes(const Shape& pred, const vector<Shape>& repeatChildren, AXIS axis) {
+int Rule::calcRepeatTimes(const Shape& pred, const vector<Shape>& repeatChildren, AXIS axis) const {
 	float sum = 0;
 	for (int i = 0; i < repeatChildren.size(); ++i) {
 		sum += repeatChildren[i].size[axis];
@@ -296,3 +450,33 @@ int Rule::calcRepeatTimes(const Shape& pred, const vector<Shape>& repeatChildren
 	
 }
 
+void Rule::addStatistics(const Shape& pred, const GenerationContext& context, size_t times,
+	unordered_map<string, MaterialStats>& stats) const {
+	// the successor sizes of splitRule and repeatRule
+	vector<float> ratios = calcSplitRatio(pred, children, axis, context);
+	vec3 childSize = vec3(pred.size);
+	if (type == repeat) {
+		int repeatTimes = calcRepeatTimes(pred, children, axis);
+		if (repeatTimes <= 0) {
+			return;
+		}
+		childSize[axis] = pred.size[axis] / repeatTimes;
+		times *= repeatTimes;
+	}
+
+	for (int i = 0; i < children.size(); ++i) {
+		vec3 newSize = vec3(childSize);
+		newSize[axis] = newSize[axis] * ratios[i];
+		if (children[i].isTerminal) {
+			MaterialStats& material = stats[children[i].name];
+			material.count += times;
+			material.size += newSize * double(times);
+			material.area += newSize[0] * newSize[1] * times;
+			continue;
+		}
+		const Rule* rule = context.findRule(children[i].name);
+		if (rule != nullptr) {
+			rule->addStatistics(Shape(children[i].name, false, newSize, pred.position), context, times, stats);
+		}
+	}
+}
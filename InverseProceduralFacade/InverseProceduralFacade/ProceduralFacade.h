@@ -4,6 +4,7 @@
 #include <vector>
 #include <queue>   
 #include <string>
+#include <memory>
 #include "vec.h"
 
 
@@ -22,6 +23,22 @@ public:
 	~Shape() {}
 };
 
+// the folder that holds the grammar, material and meta folders; the
+// constructors of Grammar and Facade read from it unless told otherwise
+extern const string defaultDataDir;
+
+class GenerationContext;
+
+// how much of one material a facade holds
+class MaterialStats {
+public:
+	size_t count;
+	vec3 size;    // the sizes of its shapes added up
+	double area;  // width * height of its shapes added up
+
+	MaterialStats(): count(0), size(0, 0, 0), area(0) {}
+};
+
 class Rule {
 public:
 	typedef enum { split, repeat } RULE_TYPE;
@@ -35,46 +52,70 @@ public:
 	vector<Shape> children;
 
 	void addChild(Shape& child);
-	vector<Shape> applyTo(const Shape& shape);
-	vector<Shape> splitRule(const Shape& pred, AXIS axis);
-	vector<Shape> repeatRule(const Shape& pred, AXIS axis);
-	vector<float> calcSplitRatio(const Shape& pred, const vector<Shape>& children, AXIS axis);
-	int calcRepeatTimes(const Shape& pred, const vector<Shape>& repeatChildren, AXIS axis);
+	vector<Shape> applyTo(const Shape& shape, const GenerationContext& context) const;
+	vector<Shape> splitRule(const Shape& pred, AXIS axis, const GenerationContext& context) const;
+	vector<Shape> repeatRule(const Shape& pred, AXIS axis, const GenerationContext& context) const;
+	vector<float> calcSplitRatio(const Shape& pred, const vector<Shape>& children, AXIS axis, const GenerationContext& context) const;
+	int calcRepeatTimes(const Shape& pred, const vector<Shape>& repeatChildren, AXIS axis) const;
+	// adds times * the terminals of each material the rule makes from pred to
+	// stats; it follows the sizes of the successors but makes none of them
+	void addStatistics(const Shape& pred, const GenerationContext& context, size_t times,
+		unordered_map<string, MaterialStats>& stats) const;
 
 	Rule(const string& predecessor, int axisId, int ruleType, int numOfChildren);
 	~Rule() {}
 };
 
+// everything one derivation reads and writes: the rules of its grammar and the
+// terminal shapes it produced.  Each facade owns its own context, so several
+// facades can be held and expanded at the same time.
+class GenerationContext {
+public:
+	unordered_map<string, Rule> ruleTable;
+	unordered_map<string, vector<Shape>> shapeTable;  // key: materialsName, value: list of Shapes
+
+	const Rule* findRule(const string& shapeName) const;
+	void addTerminal(const Shape& shape);
+
+	GenerationContext() {}
+	~GenerationContext() {}
+};
+
 class Grammar {
 public:
 	string name;
-	unordered_map<string, Rule> ruleTable;
+	shared_ptr<GenerationContext> context;
 	void parseGrammarFromFile(const string& filePath);
 	void addRule(string line);
 	Rule getRuleByShape(const Shape& shape);
-	Grammar(const string& name = "Layout");
+	// the terminals of each material an axiom of the given size expands to
+	unordered_map<string, MaterialStats> statistics(const vec3& size, const string& axiomName = "building") const;
+	Grammar(const string& name = "Layout", shared_ptr<GenerationContext> context = make_shared<GenerationContext>(),
+		const string& dataDir = defaultDataDir);
 	~Grammar() {}
 };
 
 class Facade {
 public:
 	string name;
+	string dataDir;
+	shared_ptr<GenerationContext> context;
 	Grammar grammar;
 	Shape axiom;
 	unordered_map<string, string> materialTable;
-	unordered_map<string, vector<Shape>> shapeTable;  // key: materialsName, value: list of Shapes
-	queue<Shape> queue;
 
 	void loadMaterialsFromFile(const string& filePath);
-	void expand();
-
-	Facade(const string& facadeName, const vec3& defualtSize);
+	// threads > 1 expands independent subtrees in parallel, 0 uses every core;
+	// the shapes come out in the same order for any number of threads
+	void expand(unsigned threads = 1);
+	// the number of terminals of each material expand makes
+	unordered_map<string, size_t> countTerminals() const;
+	unordered_map<string, MaterialStats> statistics() const;
+
+	Facade(const string& facadeName, const vec3& defualtSize, const string& dataDir = defaultDataDir);
 	~Facade() {}
 };
 
-extern unordered_map<string, vector<Shape>> expandResultsTable;
-extern unordered_map<string, Rule> finalRuleTable;
-
 
 
 
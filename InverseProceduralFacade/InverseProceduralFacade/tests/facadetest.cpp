@@ -0,0 +1,294 @@
+// checks the parts of the plugin that do not need Maya: the derivation on one and
+// on several threads, the terminal counts and statistics, the exporter and the
+// mesh reader.  Run from the build directory; it writes its files there.
+#include "ProceduralFacade.h"
+#include "FacadeExport.h"
+#include "PrimitiveMesh.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+const string dataDir = FACADE_DATA_DIR;
+const char* facadeNames[] = { "Layout", "NR07031" };
+
+int passed = 0;
+int failed = 0;
+
+bool check(const string& name, bool ok) {
+	if (ok) {
+		++passed;
+	}
+	else {
+		++failed;
+	}
+	printf("[%s] %s\n", ok ? "pass" : "fail", name.c_str());
+	return ok;
+}
+
+vec3 facadeSize(double width) {
+	return vec3(width, width * 0.68371, 0.3);
+}
+
+// the same shapes of every material in the same order
+bool sameShapes(const unordered_map<string, vector<Shape>>& a, const unordered_map<string, vector<Shape>>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (auto& entry : a) {
+		auto found = b.find(entry.first);
+		if (found == b.end() || found->second.size() != entry.second.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < entry.second.size(); ++i) {
+			for (int k = 0; k < 3; ++k) {
+				if (entry.second[i].position[k] != found->second[i].position[k] || entry.second[i].size[k] != found->second[i].size[k]) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+string readFile(const string& filePath) {
+	ifstream in(filePath, ios::binary);
+	stringstream buffer;
+	buffer << in.rdbuf();
+	return buffer.str();
+}
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// facades expanded on threads of their own give what they give one after another
+void testContexts() {
+	vector<unordered_map<string, vector<Shape>>> serial;
+	for (const char* name : facadeNames) {
+		for (double width : { 1.0, 17.0 }) {
+			Facade facade(name, facadeSize(width), dataDir);
+			facade.expand();
+			serial.push_back(facade.context->shapeTable);
+		}
+	}
+	vector<unordered_map<string, vector<Shape>>> parallel(serial.size());
+	vector<thread> pool;
+	for (size_t i = 0; i < serial.size(); ++i) {
+		pool.push_back(thread([&parallel, i]() {
+			Facade facade(facadeNames[i / 2], facadeSize(i % 2 == 0 ? 1.0 : 17.0), dataDir);
+			facade.expand();
+			parallel[i] = facade.context->shapeTable;
+		}));
+	}
+	for (size_t i = 0; i < pool.size(); ++i) {
+		pool[i].join();
+	}
+	bool same = true;
+	for (size_t i = 0; i < serial.size(); ++i) {
+		same = same && !serial[i].empty() && sameShapes(serial[i], parallel[i]);
+	}
+	check("facades expanded at the same time keep their own shapes", same);
+}
+
+// expand on any number of threads gives the shapes of the serial expand in its order
+void testParallelExpand() {
+	for (const char* name : facadeNames) {
+		for (double width : { 1.0, 3.0, 17.0, 60.0 }) {
+			Facade facade(name, facadeSize(width), dataDir);
+			facade.expand();
+			unordered_map<string, vector<Shape>> serial = facade.context->shapeTable;
+			bool same = true;
+			for (unsigned threads : { 2u, 3u, 8u, 0u }) {
+				facade.expand(threads);
+				same = same && sameShapes(serial, facade.context->shapeTable);
+			}
+			check(string("expand ") + name + " " + to_string(int(width)) + " on 2, 3, 8 and all threads", same);
+		}
+	}
+
+	// timings only; they depend on the machine and are not checked
+	Facade facade("Layout", facadeSize(600.0), dataDir);
+	for (unsigned threads : { 1u, max(2u, thread::hardware_concurrency()) }) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		facade.expand(threads);
+		size_t terminals = 0;
+		for (auto& entry : facade.context->shapeTable) {
+			terminals += entry.second.size();
+		}
+		printf("       expand Layout 600 on %u threads: %zu terminals in %.1f ms\n", threads, terminals, elapsedMs(start));
+	}
+}
+
+// countTerminals predicts what expand makes, and expand reserves exactly that
+void testCounts() {
+	for (const char* name : facadeNames) {
+		bool exact = true;
+		for (double width : { 0.3, 1.0, 2.5, 17.0, 333.3 }) {
+			for (unsigned threads : { 1u, 3u }) {
+				Facade facade(name, facadeSize(width), dataDir);
+				unordered_map<string, size_t> counts = facade.countTerminals();
+				facade.expand(threads);
+				exact = exact && counts.size() == facade.context->shapeTable.size();
+				for (auto& entry : facade.context->shapeTable) {
+					exact = exact && counts[entry.first] == entry.second.size() && entry.second.capacity() == entry.second.size();
+				}
+			}
+		}
+		check(string("countTerminals of ") + name + " is the size and capacity expand makes", exact);
+	}
+}
+
+// statistics adds up what expand makes without making it
+void testStatistics() {
+	for (const char* name : facadeNames) {
+		Facade facade(name, facadeSize(1.0), dataDir);
+		bool same = true;
+		for (double width : { 0.3, 1.0, 2.5, 17.0, 333.3 }) {
+			facade.axiom.size = facadeSize(width);
+			unordered_map<string, MaterialStats> stats = facade.statistics();
+			facade.expand();
+			same = same && stats.size() == facade.context->shapeTable.size();
+			for (auto& entry : facade.context->shapeTable) {
+				double area = 0;
+				vec3 size(0, 0, 0);
+				for (size_t i = 0; i < entry.second.size(); ++i) {
+					area += entry.second[i].size[0] * entry.second[i].size[1];
+					size += entry.second[i].size;
+				}
+				const MaterialStats& material = stats[entry.first];
+				same = same && material.count == entry.second.size() && fabs(material.area - area) <= 1e-9 * (1 + area);
+				for (int k = 0; k < 3; ++k) {
+					same = same && fabs(material.size[k] - size[k]) <= 1e-9 * (1 + fabs(size[k]));
+				}
+			}
+		}
+		check(string("statistics of ") + name + " match its expanded shapes", same);
+	}
+}
+
+size_t countVertices(const string& obj) {
+	istringstream in(obj);
+	string line;
+	size_t vertices = 0;
+	while (getline(in, line)) {
+		if (line.compare(0, 2, "v ") == 0) {
+			++vertices;
+		}
+	}
+	return vertices;
+}
+
+// every face id of an OBJ names a vertex it has
+bool idsInRange(const string& obj) {
+	istringstream in(obj);
+	string line;
+	size_t vertices = countVertices(obj), maxId = 0;
+	while (getline(in, line)) {
+		if (line.compare(0, 2, "f ") == 0) {
+			istringstream corners(line.substr(2));
+			string corner;
+			while (corners >> corner) {
+				size_t id = stoul(corner);
+				if (id == 0) {
+					return false;
+				}
+				maxId = max(maxId, id);
+			}
+		}
+	}
+	return vertices > 0 && maxId <= vertices;
+}
+
+void testExporter() {
+	Facade facade("NR07031", facadeSize(1.0), dataDir);
+	facade.expand();
+	FacadeExporter exporter(dataDir);
+	check("exporter reads every mesh of NR07031", exporter.loadMeshes(facade));
+	bool written = exporter.writeObj(facade, "facade1.obj", 1) && exporter.writeObj(facade, "facade4.obj", 4);
+	string obj = readFile("facade1.obj");
+	check("writeObj of NR07031", written);
+	check("writeObj on 1 and 4 threads writes the same file", !obj.empty() && obj == readFile("facade4.obj"));
+	check("writeObj face ids are in range", idsInRange(obj));
+	check("writeInstances of NR07031", exporter.writeInstances(facade, "facade.txt"));
+
+	// a mesh with one good face and faces with ids of 0 and past the end
+	string material = facade.context->shapeTable.begin()->first;
+	ofstream("bad.obj") << "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\nf 0 1 2\nf 1 2 4\nf 1//2 2//1 3//1\n";
+	facade.materialTable[material] = "bad.obj";
+	written = exporter.writeObj(facade, "bad1.obj");
+	obj = readFile("bad1.obj");
+	check("writeObj leaves out faces with ids out of range", written && idsInRange(obj));
+
+	// a mesh changed between two exports through the same cache is read again
+	ofstream("bad.obj", ios::app) << "v 9 9 9\n";
+	exporter.writeObj(facade, "bad2.obj");
+	size_t added = countVertices(readFile("bad2.obj")) - countVertices(obj);
+	check("writeObj reads a changed mesh again", added == facade.context->shapeTable[material].size());
+
+	facade.materialTable[material] = "missing.obj";
+	check("writeObj is false when a material has no mesh", !exporter.writeObj(facade, "nomesh.obj"));
+}
+
+void testMesh() {
+	// the floats of the reader are those of strtof
+	mt19937_64 random(50);
+	const char* formats[] = { "%.6f", "%.7f", "%.3f", "%.9g", "%.12g", "%.4e", "%.17g", "%.1f" };
+	size_t differ = 0;
+	PrimitiveMesh mesh;
+	for (int i = 0; i < 200000; ++i) {
+		double d = ldexp(double(random() % 100000000) / 1e4, int(random() % 40) - 20) * ((random() & 1) ? -1 : 1);
+		char number[64];
+		snprintf(number, sizeof(number), formats[i % 8], d);
+		string text = string("v ") + number + " 0 0\n";
+		mesh.loadFromText(text.data(), text.data() + text.size());
+		float expected = strtof(number, nullptr);
+		if (mesh.positions.size() != 3 || memcmp(&mesh.positions[0], &expected, sizeof(float)) != 0) {
+			++differ;
+		}
+	}
+	check("mesh floats are those of strtof, and a second load replaces the first", differ == 0);
+
+	// every material mesh reads and packs
+	Facade facade("NR07031", facadeSize(1.0), dataDir);
+	FacadeExporter exporter(dataDir);
+	bool packed = true;
+	for (auto& entry : facade.materialTable) {
+		PrimitiveMesh material;
+		packed = packed && material.loadFromFile(exporter.meshPath(facade, entry.first)) && material.numVertices() > 0;
+		size_t triangles = 0;
+		for (size_t f = 0; f < material.faceSizes.size(); ++f) {
+			triangles += material.faceSizes[f] - 2;
+		}
+		packed = packed && material.packedIndices.size() == 3 * triangles;
+		for (size_t i = 0; i < material.packedIndices.size(); ++i) {
+			packed = packed && material.packedIndices[i] < material.packedVertices.size() / PrimitiveMesh::packedStride;
+		}
+	}
+	check("material meshes of NR07031 read and pack", packed);
+
+	MeshCache cache;
+	ofstream("cached.obj") << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+	shared_ptr<const PrimitiveMesh> first = cache.get("cached.obj");
+	check("MeshCache hands out the mesh it read", first && first == cache.get("cached.obj") && cache.size() == 1);
+	ofstream("cached.obj", ios::app) << "v 1 1 0\n";
+	shared_ptr<const PrimitiveMesh> changed = cache.get("cached.obj");
+	check("MeshCache reads a changed file again", changed && changed != first && changed->numVertices() == 4);
+	check("MeshCache gives nullptr for a missing file", !cache.get("missing.obj"));
+}
+
+int main() {
+	testContexts();
+	testParallelExpand();
+	testCounts();
+	testStatistics();
+	testExporter();
+	testMesh();
+	printf("\nPass %d, Fail %d\n", passed, failed);
+	return failed;
+}
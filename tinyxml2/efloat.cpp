@@ -29,6 +29,14 @@ Efloat::Efloat(float vf, float errf, NumberType nn): v{vf}, err{errf}, n{nn}
 	{
 		err += roundingError();
 	}
+	setBounds();
+}
+Efloat Efloat::normal(float vf, float errf)
+{
+	// PowerOf2 adds no rounding error
+	Efloat e(vf, errf, NumberType::PowerOf2);
+	e.n = NumberType::Normal;
+	return e;
 }
 Efloat::~Efloat() {}
 // handles addition: if the sum of the two numbers or if either one is exactly zero,
@@ -69,6 +77,7 @@ Efloat&  Efloat::operator+=(const Efloat f1)
         err +=Efloat::roundingError();
 	// if either one is exact need to add Rounding Error to sum
 	n = Efloat::Normal;
+	setBounds();
 #ifndef NDEBUG
   	ld += f1.ld;
 #endif
@@ -83,6 +92,7 @@ Efloat&  Efloat::operator-=(const Efloat f1)
   	v -= f1.v;
     err +=Efloat::roundingError();
 	n = Efloat::Normal;
+	setBounds();
 #ifndef NDEBUG
   	ld -= f1.ld;
 #endif
@@ -109,6 +119,7 @@ Efloat Efloat::timesEquals(const Efloat f1)
 	err = std::fabs(f1.v) * err + std::fabs(v) * f1.err;
 	v *= f1.v;
 	err += roundingError();
+	setBounds();
 #ifndef NDEBUG
 	ld *= f1.ld;
 #endif
@@ -149,6 +160,7 @@ Efloat&  Efloat::operator*= (const Efloat f1)
 	if (n == Efloat::Normal) {
         	err +=Efloat::roundingError();
 	}
+	setBounds();
 #ifndef NDEBUG
 	ld *= f1.ld;
 #endif
@@ -277,6 +289,7 @@ Efloat&  Efloat::operator/=(const Efloat f0)
 	if (n == Efloat::Normal) {
 		err +=Efloat::roundingError();
 	}
+	setBounds();
 #ifndef NDEBUG
 	ld /= f0.ld;
 #endif
@@ -296,24 +309,6 @@ Efloat&  Efloat::operator/=(const Efloat f0)
 //		err = 0.0f;
 //		return *this;
 //	}
-bool    operator==(const Efloat f0, const Efloat f1)
-{
-    // short cut 
-    if (f0.v == f1.v) {
-    		return true;
-    }
-    bool nequal{!(f0 < f1) &&  !(f1 < f0)};	
-  /*  float fu {f0.upperBound()};
-    float fl {f1.lowerBound()};
-    bool nequal{ fu > fl};
-    if (nequal) {
-        fu = f1.upperBound();
-        fl = f0.lowerBound();
-        nequal = fu > fl;
-    }
-    nequal =     nequal && f0.n == f1.n;*/
-    return nequal;
-}
 bool    Efloat::isNeg() const
 {
          return std::signbit(v);
@@ -330,6 +325,7 @@ Efloat  Efloat::abs() const
 {
     	Efloat val { *this};
 	val.v = std::abs(val.v);
+	val.setBounds();
 #ifndef NDEBUG
 	val.ld = std::abs(val.ld);
 #endif
@@ -393,13 +389,6 @@ float Efloat::getAbsoluteError() const
 {
 	return err;
 }
-float Efloat::upperBound() const
-{
-//	FloatParts fp(v + err);
-//	return fp.nextFloatUp();
-        // v + err should be the max
-        return v + err;
-}
 // Less than or equal to the real number
 // idea: For normal numbers we added the roundingError in every case
 // which adds to the real error. For testing, we want a upper bound but one that
@@ -416,12 +405,6 @@ float   Efloat::upperRealBound() const
 	}
     return b;
 }
-float Efloat::lowerBound() const
-{
-//	FloatParts fp(v - err);
-//	return fp.nextFloatDown();
-	return v - err;
-}
 // see comment for upperRealBound -same applies here.
 float   Efloat::lowerRealBound() const
 {
@@ -450,6 +433,7 @@ Efloat::Efloat(float vf, long double ldd, float errf,  NumberType nn ):  v{vf},
 	if (nn == Efloat::Normal){
 		err += roundingError();
 	}
+	setBounds();
 }
 float Efloat::getRelativeError() const
 {
@@ -468,6 +452,7 @@ Efloat Efloat::operator-() const
 {
        Efloat neg { *this};
        neg.v = -v;
+       neg.setBounds();
 #ifndef NDEBUG
        neg.ld = - ld;
 #endif
@@ -556,25 +541,6 @@ bool lessThan(const Efloat a, const Efloat b)
 {
 	return a.v < b.v;
 }
-bool operator<(const Efloat a, const Efloat b)
-{
-          
-	float aupper { a.upperBound()};
-	float blower { b.lowerBound()};
-	return  aupper < blower;
-}
-bool operator>(const Efloat a, const Efloat b)
-{
-	return b < a;
-}
-bool operator<=(const Efloat a, const Efloat b)
-{
-	return !(b < a);
-}
-bool operator>=(const Efloat a, const Efloat b)
-{
-	return !(a < b);
-}
 // selects efloat with lower lowerBound
 Efloat EMin(const Efloat a, const Efloat b)
 {
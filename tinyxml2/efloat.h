@@ -30,6 +30,9 @@ class Efloat {
 		// otherwise rounding Error added
 		Efloat(float vf, NumberType n);
 		Efloat(float vf, float errf = 0.0f, NumberType n = NumberType::Normal);
+		// a Normal Efloat whose errf already holds its rounding error; for
+		// results computed outside Efloat such as the batch kernels
+		static Efloat normal(float vf, float errf);
                 friend Efloat  operator+(const Efloat f0, const Efloat f1);
 	        friend Efloat  operator-(const Efloat f0, const Efloat f1);
 		friend Efloat  operator*(const Efloat f0, const Efloat f1);
@@ -55,12 +58,12 @@ class Efloat {
 		float   getAbsoluteError() const;
 		// the highest float that could be the number greater than or equal
 		// to the real number
-		float   upperBound() const;
+		float   upperBound() const { return hi;}
 		// Less than or equal to the real number
         	float   upperRealBound() const;
 		// the lowest float that could be the number; less than the real
 		// number
-		float   lowerBound() const;
+		float   lowerBound() const { return lo;}
 		// greater than or equal to the real number
 		float  lowerRealBound() const;
 
@@ -88,6 +91,12 @@ class Efloat {
 		float v;
 		float err;
 		NumberType n;
+		// the bounds v - err and v + err, kept up to date by every
+		// constructor and operator that changes v or err so a comparison
+		// is two loads and one float compare
+		float lo;
+		float hi;
+		void setBounds() { lo = v - err; hi = v + err;}
 		// calculates the rounding error
 #ifndef NDEBUG
 		long double ld;
@@ -113,10 +122,30 @@ Efloat::Quadratic quadratic(const Efloat::Coefficients& abc);
 // lower bound of b.  Equals based on this operator does not
 // respect the transitive property. because if a == b and b == c
 // a may not equal c.
-bool operator<(const Efloat a, const Efloat b);
-bool operator<=(const Efloat a, const Efloat b);
-bool operator>(const Efloat a, const Efloat b);
-bool operator>=(const Efloat a, const Efloat b);
+inline bool operator<(const Efloat a, const Efloat b)
+{
+	return a.upperBound() < b.lowerBound();
+}
+inline bool operator<=(const Efloat a, const Efloat b)
+{
+	return !(b < a);
+}
+inline bool operator>(const Efloat a, const Efloat b)
+{
+	return b < a;
+}
+inline bool operator>=(const Efloat a, const Efloat b)
+{
+	return !(a < b);
+}
+inline bool operator==(const Efloat f0, const Efloat f1)
+{
+	// short cut
+	if (f0.v == f1.v) {
+		return true;
+	}
+	return !(f0 < f1) && !(f1 < f0);
+}
 //makes an evector out of a vec3 adds machine precision to all numbers and treats
 //them as normal Efloats not exact.  Optionally add an error to all of the numbers.
 // these select the Efloat that produces the min lowerbound or the max upperbound.
@@ -0,0 +1,74 @@
+/*****************************************************************************************************
+ * facadegen  writes a synthetic SerializableFacade for scale testing BottomUp.
+ *
+ * usage:   facadegen [--rows R] [--cols C] [--tile RxC] [--repeat rate]
+ * 		      [--depth D] [--seed S] [-o out.xml]
+ * 		rows * cols is the number of terminals.  Without -o the facade
+ * 		is written to stdout.  See syntheticFacade.h for the parameters.
+ *****************************************************************************************************/
+#include "syntheticFacade.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+static void usage()
+{
+	fprintf(stderr, "usage: facadegen [--rows R] [--cols C] [--tile RxC] [--repeat rate]\n"
+			"                 [--depth D] [--seed S] [-o out.xml]\n");
+	exit(1);
+}
+
+int main(int argc, const char ** argv)
+{
+	Layout::SyntheticFacade params;
+	std::string out;
+	for (int i {1}; i < argc; ++i)
+	{
+		if (i + 1 >= argc) {
+			usage();
+		}
+		const char* arg { argv[i]};
+		const char* val { argv[++i]};
+		if (std::strcmp(arg, "--rows") == 0) {
+			params.rows = static_cast<unsigned>(std::atoi(val));
+		}
+		else if (std::strcmp(arg, "--cols") == 0) {
+			params.cols = static_cast<unsigned>(std::atoi(val));
+		}
+		else if (std::strcmp(arg, "--tile") == 0) {
+			if (std::sscanf(val, "%ux%u", &params.tileRows, &params.tileCols) != 2) {
+				usage();
+			}
+		}
+		else if (std::strcmp(arg, "--repeat") == 0) {
+			params.repeatRate = static_cast<float>(std::atof(val));
+		}
+		else if (std::strcmp(arg, "--depth") == 0) {
+			params.depth = static_cast<unsigned>(std::atoi(val));
+		}
+		else if (std::strcmp(arg, "--seed") == 0) {
+			params.seed = static_cast<unsigned>(std::atoi(val));
+		}
+		else if (std::strcmp(arg, "-o") == 0) {
+			out = val;
+		}
+		else {
+			usage();
+		}
+	}
+	try {
+		if (out.empty()) {
+			Layout::writeSyntheticFacade(params, stdout);
+		}
+		else {
+			Layout::writeSyntheticFacade(params, out);
+		}
+	}
+	catch (const std::runtime_error& e) {
+		fprintf(stderr, "facadegen: %s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include "intervalBatch.h"
+#include <cmath>
+#include <stdexcept>
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+	constexpr float Gamma1 {Efloat::gamma(1)};
+
+	// the error Efloat's + and - use for f; only for the arithmetic kernels, as
+	// Efloat's comparisons use f's own bounds
+	float addError(const Efloat f)
+	{
+		return (f.getType() == Efloat::PowerOf2) ? f.roundingError() : f.getAbsoluteError();
+	}
+
+	// the scalar kernels; the same operations in the same order as efloat.cpp
+	struct ScalarLanes {
+		typedef float V;
+		static const std::size_t Width {1};
+		static V load(const float* p) { return *p;}
+		static void store(float* p, V a) { *p = a;}
+		static V set(float f) { return f;}
+		static V add(V a, V b) { return a + b;}
+		static V sub(V a, V b) { return a - b;}
+		static V mul(V a, V b) { return a * b;}
+		static V abs(V a) { return std::fabs(a);}
+		// number of lanes with !(a < b)
+		static std::size_t countNotLess(V a, V b) { return !(a < b) ? 1 : 0;}
+	};
+	// the number of set bits of a 4 bit movemask; MSVC has no __builtin_popcount
+	const unsigned char maskBits[16] {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+#if defined(__AVX__)
+	struct Lanes {
+		typedef __m256 V;
+		static const std::size_t Width {8};
+		static V load(const float* p) { return _mm256_loadu_ps(p);}
+		static void store(float* p, V a) { _mm256_storeu_ps(p, a);}
+		static V set(float f) { return _mm256_set1_ps(f);}
+		static V add(V a, V b) { return _mm256_add_ps(a, b);}
+		static V sub(V a, V b) { return _mm256_sub_ps(a, b);}
+		static V mul(V a, V b) { return _mm256_mul_ps(a, b);}
+		static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);}
+		static std::size_t countNotLess(V a, V b)
+		{
+			int less { _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ))};
+			return Width - maskBits[less & 0xF] - maskBits[less >> 4];
+		}
+	};
+	const char* const LanePath {"avx"};
+#elif defined(__SSE2__) || defined(_M_X64)
+	struct Lanes {
+		typedef __m128 V;
+		static const std::size_t Width {4};
+		static V load(const float* p) { return _mm_loadu_ps(p);}
+		static void store(float* p, V a) { _mm_storeu_ps(p, a);}
+		static V set(float f) { return _mm_set1_ps(f);}
+		static V add(V a, V b) { return _mm_add_ps(a, b);}
+		static V sub(V a, V b) { return _mm_sub_ps(a, b);}
+		static V mul(V a, V b) { return _mm_mul_ps(a, b);}
+		static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a);}
+		static std::size_t countNotLess(V a, V b)
+		{
+			return Width - maskBits[_mm_movemask_ps(_mm_cmplt_ps(a, b))];
+		}
+	};
+	const char* const LanePath {"sse2"};
+#else
+	typedef ScalarLanes Lanes;
+	const char* const LanePath {"scalar"};
+#endif
+
+	// err = errn + gamma(1) * (|v| + errn): the rounding error every Normal
+	// result gets in the Efloat constructor
+	template<typename L> typename L::V rounded(typename L::V v, typename L::V errn)
+	{
+		return L::add(errn, L::mul(L::set(Gamma1), L::add(L::abs(v), errn)));
+	}
+	// a +/- b; errn = a.err + b.err
+	template<typename L, bool Minus> void addRange(const float* av, const float* ae, const float* bv,
+			const float* be, float* ov, float* oe, std::size_t i, std::size_t n)
+	{
+		for (; i + L::Width <= n; i += L::Width)
+		{
+			typename L::V errn { L::add(L::load(ae + i), L::load(be + i))};
+			typename L::V v { Minus ? L::sub(L::load(av + i), L::load(bv + i)) :
+				L::add(L::load(av + i), L::load(bv + i))};
+			L::store(oe + i, rounded<L>(v, errn));
+			L::store(ov + i, v);
+		}
+	}
+	// a * b of two Normals; errn = |b| a.err + |a| b.err + b.err a.err
+	template<typename L> void multiplyRange(const float* av, const float* ae, const float* bv,
+			const float* be, float* ov, float* oe, std::size_t i, std::size_t n)
+	{
+		for (; i + L::Width <= n; i += L::Width)
+		{
+			typename L::V a { L::load(av + i)}, aerr { L::load(ae + i)};
+			typename L::V b { L::load(bv + i)}, berr { L::load(be + i)};
+			typename L::V errn { L::mul(L::abs(b), aerr)};
+			errn = L::add(errn, L::mul(L::abs(a), berr));
+			errn = L::add(errn, L::mul(berr, aerr));
+			typename L::V v { L::mul(a, b)};
+			L::store(oe + i, rounded<L>(v, errn));
+			L::store(ov + i, v);
+		}
+	}
+	// base + a[i]; errn = base.err + a.err
+	template<typename L> void offsetRange(float base, float baseErr, const float* av, const float* ae,
+			float* ov, float* oe, std::size_t i, std::size_t n)
+	{
+		for (; i + L::Width <= n; i += L::Width)
+		{
+			typename L::V errn { L::add(L::set(baseErr), L::load(ae + i))};
+			typename L::V v { L::add(L::set(base), L::load(av + i))};
+			L::store(oe + i, rounded<L>(v, errn));
+			L::store(ov + i, v);
+		}
+	}
+	// counts !(xhi < lo[i])
+	template<typename L> std::size_t countRange(float xhi, const float* lo, std::size_t& i, std::size_t n)
+	{
+		std::size_t count {0};
+		for (; i + L::Width <= n; i += L::Width)
+		{
+			count += L::countNotLess(L::set(xhi), L::load(lo + i));
+		}
+		return count;
+	}
+	// the index where the wide loops stop and the scalar ones take over
+	std::size_t wideEnd(std::size_t n)
+	{
+		return n - n % Lanes::Width;
+	}
+	void checkSizes(const Layout::IntervalBatch& a, const Layout::IntervalBatch& b)
+	{
+		if (a.size() != b.size()) {
+			throw std::runtime_error("IntervalBatch sizes differ");
+		}
+	}
+}
+
+Layout::IntervalBatch::IntervalBatch(const std::vector<Efloat>& fs)
+{
+	reserve(fs.size());
+	for (const Efloat& f : fs)
+	{
+		push_back(f);
+	}
+}
+void Layout::IntervalBatch::push_back(const Efloat f)
+{
+	vs.push_back(float(f));
+	errs.push_back(addError(f));
+}
+const char* Layout::intervalKernelPath()
+{
+	return LanePath;
+}
+void Layout::add(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+	checkSizes(a, b);
+	std::size_t n {a.size()};
+	out.resize(n);
+	addRange<Lanes, false>(a.values(), a.errors(), b.values(), b.errors(), out.values(), out.errors(), 0, n);
+	addRange<ScalarLanes, false>(a.values(), a.errors(), b.values(), b.errors(), out.values(),
+			out.errors(), wideEnd(n), n);
+}
+void Layout::subtract(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+	checkSizes(a, b);
+	std::size_t n {a.size()};
+	out.resize(n);
+	addRange<Lanes, true>(a.values(), a.errors(), b.values(), b.errors(), out.values(), out.errors(), 0, n);
+	addRange<ScalarLanes, true>(a.values(), a.errors(), b.values(), b.errors(), out.values(),
+			out.errors(), wideEnd(n), n);
+}
+void Layout::multiply(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+	checkSizes(a, b);
+	std::size_t n {a.size()};
+	out.resize(n);
+	multiplyRange<Lanes>(a.values(), a.errors(), b.values(), b.errors(), out.values(), out.errors(), 0, n);
+	multiplyRange<ScalarLanes>(a.values(), a.errors(), b.values(), b.errors(), out.values(),
+			out.errors(), wideEnd(n), n);
+}
+void Layout::offset(const Efloat base, const IntervalBatch& a, IntervalBatch& out)
+{
+	std::size_t n {a.size()};
+	out.resize(n);
+	float v {float(base)}, err {addError(base)};
+	offsetRange<Lanes>(v, err, a.values(), a.errors(), out.values(), out.errors(), 0, n);
+	offsetRange<ScalarLanes>(v, err, a.values(), a.errors(), out.values(), out.errors(), wideEnd(n), n);
+}
+std::size_t Layout::countNotAbove(const std::vector<float>& lowerBounds, const Efloat x)
+{
+	std::size_t i {0};
+	float xhi {x.upperBound()};
+	std::size_t count { countRange<Lanes>(xhi, lowerBounds.data(), i, lowerBounds.size())};
+	return count + countRange<ScalarLanes>(xhi, lowerBounds.data(), i, lowerBounds.size());
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "efloat.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+namespace Layout {
+/*****************************************************************************************************
+ * @class    IntervalBatch holds many Efloats as a structure of arrays: all the values,
+ * 	     then all the errors.  The kernels below work on whole batches with
+ * 	     SSE2, or with AVX when the library is built with LAYOUT_AVX, and fall
+ * 	     back to scalar code for the last few elements and on other CPUs.
+ * 	     Their results are bit for bit those of the Efloat operators.
+ * @Note     Every element is Normal.  An exact (PowerOf2) Efloat is stored with
+ * 	     its rounding error, which is the error + and - give it anyway, so
+ * 	     only * of exact numbers gets a larger error than Efloat's.  Its bounds
+ * 	     are then wider than the Efloat's, so comparisons use lower bounds
+ * 	     taken from the Efloats instead (see countNotAbove).
+ * ***************************************************************************************************/
+	class IntervalBatch {
+	public:
+		IntervalBatch() {}
+		explicit IntervalBatch(const std::vector<Efloat>& fs);
+		std::size_t size() const { return vs.size();}
+		bool empty() const { return vs.empty();}
+		void reserve(std::size_t n) { vs.reserve(n); errs.reserve(n);}
+		void clear() { vs.clear(); errs.clear();}
+		void push_back(const Efloat f);
+		Efloat operator[](std::size_t i) const { return Efloat::normal(vs[i], errs[i]);}
+		// the values and the errors; the kernels resize them together
+		const float* values() const { return vs.data();}
+		const float* errors() const { return errs.data();}
+		float* values() { return vs.data();}
+		float* errors() { return errs.data();}
+		void resize(std::size_t n) { vs.resize(n); errs.resize(n);}
+	private:
+		std::vector<float> vs;
+		std::vector<float> errs;
+	};
+	// the instruction set the kernels were built for: "avx", "sse2" or "scalar"
+	const char* intervalKernelPath();
+/*****************************************************************************************************
+ * @func     add, subtract, multiply  out[i] = a[i] op b[i] for every i.  a and b have
+ * 		the same size; out may be a or b.
+ * ***************************************************************************************************/
+	void add(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+	void subtract(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+	void multiply(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+/*****************************************************************************************************
+ * @func     offset  out[i] = base + a[i]: the corners of the children of a node from
+ * 		its corner and its splits.  out may be a.
+ * ***************************************************************************************************/
+	void offset(const Efloat base, const IntervalBatch& a, IntervalBatch& out);
+/*****************************************************************************************************
+ * @func     countNotAbove returns how many splits are not above x, !(x < split), from
+ * 		the lowerBound() of each split.  For sorted splits that are further
+ * 		apart than their errors this is std::upper_bound(splits, x): the
+ * 		index of the child that holds x.
+ * ***************************************************************************************************/
+	std::size_t countNotAbove(const std::vector<float>& lowerBounds, const Efloat x);
+/*****************************************************************************************************
+ * @class    SplitIndex finds the child of a node that holds a coordinate.  For most
+ * 	     scalars it is std::upper_bound on the splits; for Efloat it keeps the
+ * 	     lower bounds of the splits and counts them with countNotAbove, which
+ * 	     beats the binary search up to about LinearLimit splits.
+ * ***************************************************************************************************/
+	template<typename S> class SplitIndex {
+	public:
+		explicit SplitIndex(const std::vector<S>&) {}
+		std::size_t upperBound(const std::vector<S>& splits, const S x) const
+		{
+			return std::upper_bound(splits.cbegin(), splits.cend(), x) - splits.cbegin();
+		}
+	};
+	template<> class SplitIndex<Efloat> {
+	public:
+		static const std::size_t LinearLimit {64};
+		explicit SplitIndex(const std::vector<Efloat>& splits)
+		{
+			if (splits.size() <= LinearLimit) {
+				lowerBounds.reserve(splits.size());
+				for (const Efloat& split : splits)
+				{
+					lowerBounds.push_back(split.lowerBound());
+				}
+			}
+		}
+		std::size_t upperBound(const std::vector<Efloat>& splits, const Efloat x) const
+		{
+			if (splits.size() > LinearLimit) {
+				return std::upper_bound(splits.cbegin(), splits.cend(), x) - splits.cbegin();
+			}
+			return countNotAbove(lowerBounds, x);
+		}
+	private:
+		std::vector<float> lowerBounds;
+	};
+}
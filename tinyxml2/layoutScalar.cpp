@@ -0,0 +1,11 @@
+#include "layoutScalar.h"
+
+std::ostream& Layout::operator<<(std::ostream& ostr, const EpsFloat a)
+{
+	return ostr << float(a);
+}
+
+std::ostream& Layout::operator<<(std::ostream& ostr, const FixedScalar a)
+{
+	return ostr << float(a);
+}
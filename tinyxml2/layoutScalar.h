@@ -0,0 +1,153 @@
+#pragma once
+#include "efloat.h"
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+// Layout::Scalar is the number type of every position, size and split in the
+// Layout engine.  It is picked at compile time with LAYOUT_SCALAR, which must be
+// the same for the library and everything including parseLayout.h:
+//   0  Efloat       interval arithmetic that tracks the error of every value.
+//                   For facades from scans or editors without a grid.
+//   1  EpsFloat     a plain float; values closer than LAYOUT_EPSILON are equal.
+//   2  FixedScalar  an integer count of 2^-LAYOUT_FIXED_BITS units; sums are
+//                   exact and values LAYOUT_FIXED_SLACK units apart are equal.
+// The last two do no interval arithmetic.  They suit facades from a grid
+// editor, whose coordinates only differ by rounding.
+#ifndef LAYOUT_SCALAR
+#define LAYOUT_SCALAR 0
+#endif
+#ifndef LAYOUT_EPSILON
+#define LAYOUT_EPSILON 1e-5f
+#endif
+#ifndef LAYOUT_FIXED_BITS
+#define LAYOUT_FIXED_BITS 20
+#endif
+#ifndef LAYOUT_FIXED_SLACK
+#define LAYOUT_FIXED_SLACK 16
+#endif
+namespace Layout {
+/*****************************************************************************************************
+ * @class    EpsFloat is a float compared within an absolute epsilon.  Like Efloat,
+ * 	     a < b means a is less by more than the error, so a == b is
+ * 	     !(a < b) && !(b < a) and is not transitive.
+ * ***************************************************************************************************/
+	class EpsFloat {
+	public:
+		static constexpr float Epsilon {LAYOUT_EPSILON};
+		EpsFloat(): v{0.f} {}
+		explicit EpsFloat(float f): v{f} {}
+		explicit operator float() const { return v;}
+		EpsFloat& operator+=(const EpsFloat o) { v += o.v; return *this;}
+		EpsFloat& operator-=(const EpsFloat o) { v -= o.v; return *this;}
+		EpsFloat& operator*=(const EpsFloat o) { v *= o.v; return *this;}
+		EpsFloat& operator/=(const EpsFloat o) { v /= o.v; return *this;}
+		EpsFloat operator-() const { return EpsFloat(-v);}
+		friend EpsFloat operator+(const EpsFloat a, const EpsFloat b) { return EpsFloat(a.v + b.v);}
+		friend EpsFloat operator-(const EpsFloat a, const EpsFloat b) { return EpsFloat(a.v - b.v);}
+		friend EpsFloat operator*(const EpsFloat a, const EpsFloat b) { return EpsFloat(a.v * b.v);}
+		friend EpsFloat operator/(const EpsFloat a, const EpsFloat b) { return EpsFloat(a.v / b.v);}
+		friend bool operator<(const EpsFloat a, const EpsFloat b) { return a.v + Epsilon < b.v;}
+		friend bool operator==(const EpsFloat a, const EpsFloat b) { return !(a < b) && !(b < a);}
+		friend bool operator<=(const EpsFloat a, const EpsFloat b) { return !(b < a);}
+		friend bool operator>(const EpsFloat a, const EpsFloat b) { return b < a;}
+		friend bool operator>=(const EpsFloat a, const EpsFloat b) { return !(a < b);}
+	private:
+		float v;
+	};
+/*****************************************************************************************************
+ * @class    FixedScalar counts units of 2^-LAYOUT_FIXED_BITS in 64 bits.  Adding and
+ * 	     subtracting are exact, so the only error is the rounding of each
+ * 	     input, and a < b means a is less by more than LAYOUT_FIXED_SLACK
+ * 	     units.  Multiplying and dividing round to the nearest unit.
+ * ***************************************************************************************************/
+	class FixedScalar {
+	public:
+		typedef std::int64_t Units;
+		static constexpr Units One {Units{1} << LAYOUT_FIXED_BITS};
+		static constexpr Units Slack {LAYOUT_FIXED_SLACK};
+		FixedScalar(): u{0} {}
+		explicit FixedScalar(float f): u{static_cast<Units>(std::llround(static_cast<double>(f) * One))} {}
+		explicit operator float() const { return static_cast<float>(static_cast<double>(u) / One);}
+		FixedScalar& operator+=(const FixedScalar o) { u += o.u; return *this;}
+		FixedScalar& operator-=(const FixedScalar o) { u -= o.u; return *this;}
+		FixedScalar& operator*=(const FixedScalar o) { *this = *this * o; return *this;}
+		FixedScalar& operator/=(const FixedScalar o) { *this = *this / o; return *this;}
+		FixedScalar operator-() const { return units(-u);}
+		friend FixedScalar operator+(const FixedScalar a, const FixedScalar b) { return units(a.u + b.u);}
+		friend FixedScalar operator-(const FixedScalar a, const FixedScalar b) { return units(a.u - b.u);}
+		friend FixedScalar operator*(const FixedScalar a, const FixedScalar b)
+		{
+			return units(static_cast<Units>(std::llround(static_cast<double>(a.u) * b.u / One)));
+		}
+		friend FixedScalar operator/(const FixedScalar a, const FixedScalar b)
+		{
+			return units(static_cast<Units>(std::llround(static_cast<double>(a.u) * One / b.u)));
+		}
+		friend bool operator<(const FixedScalar a, const FixedScalar b) { return a.u + Slack < b.u;}
+		friend bool operator==(const FixedScalar a, const FixedScalar b) { return !(a < b) && !(b < a);}
+		friend bool operator<=(const FixedScalar a, const FixedScalar b) { return !(b < a);}
+		friend bool operator>(const FixedScalar a, const FixedScalar b) { return b < a;}
+		friend bool operator>=(const FixedScalar a, const FixedScalar b) { return !(a < b);}
+	private:
+		Units u;
+		static FixedScalar units(Units n) { FixedScalar f; f.u = n; return f;}
+	};
+	std::ostream& operator<<(std::ostream&, const EpsFloat a);
+	std::ostream& operator<<(std::ostream&, const FixedScalar a);
+
+#if LAYOUT_SCALAR == 1
+	typedef EpsFloat Scalar;
+#elif LAYOUT_SCALAR == 2
+	typedef FixedScalar Scalar;
+#else
+	typedef Efloat Scalar;
+#endif
+	// reads a coordinate of the XML as a Scalar.  Efloat starts with the
+	// error of the text to float conversion.
+	template<typename S> struct ScalarInput {
+		static S read(float f) { return S(f);}
+	};
+	template<> struct ScalarInput<Efloat> {
+		static Efloat read(float f) { return Efloat(f, 6e-7f, Efloat::Normal);}
+	};
+	inline Scalar toScalar(float f)
+	{
+		return ScalarInput<Scalar>::read(f);
+	}
+
+	// the axes of a BasicVector; shared by every scalar
+	struct VectorAxis {
+		enum Axis { X, Y, Z};
+	};
+/*****************************************************************************************************
+ * @class    BasicVector is a 3D vector of scalars S: the EVector of the Layout engine
+ * 	     for any scalar policy.  Vector is the one of Scalar.
+ * ***************************************************************************************************/
+	template<typename S> class BasicVector: public VectorAxis {
+	public:
+		BasicVector(): x{}, y{}, z{} {}
+		BasicVector(const S xs, const S ys, const S zs): x{xs}, y{ys}, z{zs} {}
+		const S operator[](size_t i) const { return (i == 0) ? x : (i == 1) ? y : z;}
+		S& operator[](size_t i) { return (i == 0) ? x : (i == 1) ? y : z;}
+		BasicVector& operator+=(const BasicVector& o) { x += o.x; y += o.y; z += o.z; return *this;}
+		BasicVector& operator-=(const BasicVector& o) { x -= o.x; y -= o.y; z -= o.z; return *this;}
+		S x, y, z;
+	};
+	template<typename S> bool operator==(const BasicVector<S>& a, const BasicVector<S>& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+	template<typename S> BasicVector<S> operator+(const BasicVector<S>& a, const BasicVector<S>& b)
+	{
+		return BasicVector<S>(a.x + b.x, a.y + b.y, a.z + b.z);
+	}
+	template<typename S> BasicVector<S> operator-(const BasicVector<S>& a, const BasicVector<S>& b)
+	{
+		return BasicVector<S>(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+	template<typename S> std::ostream& operator<<(std::ostream& os, const BasicVector<S>& a)
+	{
+		return os << "(" << a.x << ", " << a.y << ", " << a.z << ")";
+	}
+	typedef BasicVector<Scalar> Vector;
+}
@@ -0,0 +1,660 @@
+/*****************************************************************************************************
+ * layoutbench  times the hot paths of the Layout subsystem so that performance
+ * 		regressions are visible between builds.
+ *
+ * usage:   layoutbench [--iterations N] [--build-only] [facade.xml ...]
+ * 		With no files it runs over the bundled facades
+ * 		(resources/Layout.xml and resources/NR07031_basic.xml are the
+ * 		same files as the .xml files in facade/ of the Maya plugin), a generated
+ * 		facade and other synthetic inputs.  Run it from the build
+ * 		directory so the resources directory is found.
+ * 		--build-only only times building the BottomUp of each file and
+ * 		prints one line per file; scaling_report.py uses it.
+ *****************************************************************************************************/
+#include "tinyxml2.h"
+#include "parseLayout.h"
+#include "syntheticFacade.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	// every operator new in the process, tinyxml2 included
+	std::atomic<unsigned long> allocations {0};
+}
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+	// keeps the optimizer from removing the timed work
+	volatile unsigned long sink {0};
+
+	double elapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+	void report(const std::string& name, const std::string& input, unsigned long ops, double ms)
+	{
+		double nsPerOp { (ops == 0) ? 0.0 : ms * 1.0e6 / static_cast<double>(ops)};
+		printf("%-26s %-22s %10lu %12.3f ms %12.1f ns/op\n", name.c_str(), input.c_str(),
+				ops, ms, nsPerOp);
+	}
+	// file name without directories for the report
+	std::string baseName(const std::string& path)
+	{
+		std::string::size_type slash { path.find_last_of("/\\")};
+		return (slash == std::string::npos) ? path : path.substr(slash + 1);
+	}
+	// collects every BBox element below node
+	void collectBBoxes(const tinyxml2::XMLNode* node, std::vector<const tinyxml2::XMLNode*>& boxes)
+	{
+		for (const tinyxml2::XMLElement* child { node ->FirstChildElement()}; child != nullptr;
+				child = child ->NextSiblingElement())
+		{
+			if (std::strcmp(child ->Name(), "BBox") == 0) {
+				boxes.push_back(child);
+			}
+			else {
+				collectBBoxes(child, boxes);
+			}
+		}
+	}
+	/*********************************************************************************************
+	 * benchBoundBox times BoundBox(const XMLNode*, const ShapeNames&) over every BBox in the
+	 * 		document.
+	 *********************************************************************************************/
+	void benchBoundBox(const tinyxml2::XMLDocument& doc, const std::string& input, unsigned iterations)
+	{
+		std::vector<const tinyxml2::XMLNode*> boxes;
+		collectBBoxes(&doc, boxes);
+		const Layout::ShapeNames xmlNames(doc);
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			for (const tinyxml2::XMLNode* box : boxes)
+			{
+				Layout::BoundBox bb(box, xmlNames);
+				sink += static_cast<unsigned long>(float(bb.size().x) != 0.f);
+			}
+		}
+		report("BoundBox parse", input, boxes.size() * iterations, elapsedMs(start));
+	}
+	/*********************************************************************************************
+	 * benchNameLookup times the FirstChildElement calls of a BBox, Min, Max and Size and
+	 * 		their X, Y and Z, by string and by interned name.
+	 *********************************************************************************************/
+	void benchNameLookup(const tinyxml2::XMLDocument& doc, const std::string& input, unsigned iterations)
+	{
+		std::vector<const tinyxml2::XMLNode*> boxes;
+		collectBBoxes(&doc, boxes);
+		const char* const corners[] {"Min", "Max", "Size"};
+		const char* const axes[] {"X", "Y", "Z"};
+		unsigned long ops { boxes.size() * 12 * static_cast<unsigned long>(iterations)};
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+			for (const tinyxml2::XMLNode* box : boxes)
+				for (const char* corner : corners)
+				{
+					const tinyxml2::XMLElement* c { box ->FirstChildElement(corner)};
+					for (const char* axis : axes)
+						sink += reinterpret_cast<std::uintptr_t>(c ->FirstChildElement(axis));
+				}
+		report("FirstChildElement(char*)", input, ops, elapsedMs(start));
+		const tinyxml2::XMLName cornerNames[] {doc.FindName("Min"), doc.FindName("Max"), doc.FindName("Size")};
+		const tinyxml2::XMLName axisNames[] {doc.FindName("X"), doc.FindName("Y"), doc.FindName("Z")};
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (const tinyxml2::XMLNode* box : boxes)
+				for (const tinyxml2::XMLName corner : cornerNames)
+				{
+					const tinyxml2::XMLElement* c { box ->FirstChildElement(corner)};
+					for (const tinyxml2::XMLName axis : axisNames)
+						sink += reinterpret_cast<std::uintptr_t>(c ->FirstChildElement(axis));
+				}
+		report("FirstChildElement(XMLName)", input, ops, elapsedMs(start));
+	}
+	// terminal GroupPairs; the ll corners of every terminal in the facade
+	std::vector<Layout::GroupPair> terminals(const Layout::BottomUp& bu)
+	{
+		std::vector<Layout::GroupPair> terms;
+		for (const Layout::GroupMap::value_type& entry : bu.groups)
+		{
+			if (entry.second.first ->terminal()) {
+				terms.push_back(entry.second);
+			}
+		}
+		return terms;
+	}
+	/*********************************************************************************************
+	 * benchLocation times findLLNode from the root and findXYLocMap along both axes at
+	 * 		every terminal corner.
+	 *********************************************************************************************/
+	void benchLocation(const Layout::BottomUp& bu, const std::string& input, unsigned iterations)
+	{
+		std::vector<Layout::GroupPair> terms { terminals(bu)};
+		std::vector<std::shared_ptr<const Layout::LeafNode>> leaves;
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			leaves.clear();
+			for (const Layout::GroupPair& term : terms)
+			{
+				Layout::Vector ll { bu.location.second};
+				leaves.push_back(Layout::findLLNode(bu.location.first, ll, term.second));
+			}
+		}
+		report("findLLNode", input, terms.size() * iterations, elapsedMs(start));
+		unsigned long found {0};
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			for (const std::shared_ptr<const Layout::LeafNode>& leaf : leaves)
+			{
+				found += leaf ->findXYLocMap(Layout::Vector::Axis::X, leaf ->size.x).size();
+				found += leaf ->findXYLocMap(Layout::Vector::Axis::Y, leaf ->size.y).size();
+			}
+		}
+		sink += found;
+		report("findXYLocMap", input, 2 * leaves.size() * iterations, elapsedMs(start));
+	}
+	/*********************************************************************************************
+	 * benchAddNTGroups builds the groups one level at a time and times every level that
+	 * 		added groups if perLevel.  Returns the fully built BottomUp.
+	 *********************************************************************************************/
+	std::unique_ptr<Layout::BottomUp> benchAddNTGroups(const char* filename, const std::string& input,
+			bool perLevel)
+	{
+		Clock::time_point start { Clock::now()};
+		std::unique_ptr<Layout::BottomUp> bu { new Layout::BottomUp(filename, 0)};
+		report("location tree", input, bu ->groups.size(), elapsedMs(start));
+		double total {0.0};
+		unsigned nTerms { bu ->location.first ->v ->n};
+		for (unsigned n {1}; n <= nTerms; ++n)
+		{
+			Layout::GroupMap::size_type before { bu ->groups.size()};
+			start = Clock::now();
+			bu ->addNTGroups(n);
+			double ms { elapsedMs(start)};
+			total += ms;
+			if (perLevel && bu ->groups.size() != before) {
+				report("addNTGroups(" + std::to_string(n) + ")", input,
+						bu ->groups.size() - before, ms);
+			}
+		}
+		report("addNTGroups total", input, bu ->groups.size(), total);
+		return bu;
+	}
+	/*********************************************************************************************
+	 * benchLocationTree times loading the file and reading its location tree on one thread
+	 * 		and on several.  xmltest checks both give the same names, groups and
+	 * 		tree.
+	 *********************************************************************************************/
+	void benchLocationTree(const char* filename, const std::string& input, unsigned iterations)
+	{
+		unsigned threads { std::max(2u, std::thread::hardware_concurrency())};
+		tinyxml2::XMLDocument doc;
+		std::unique_ptr<Layout::BottomUp> serial, parallel;
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			serial.reset(new Layout::BottomUp(filename, 0, doc, 1));
+		}
+		report("location tree 1 thread", input, iterations, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			parallel.reset(new Layout::BottomUp(filename, 0, doc, threads));
+		}
+		report("location tree " + std::to_string(threads) + " threads", input, iterations, elapsedMs(start));
+	}
+	/*********************************************************************************************
+	 * benchCopyAndRemove times the BottomUp copy and then removeNodes of every
+	 * 		repeated non terminal group in the copy.
+	 *********************************************************************************************/
+	void benchCopyAndRemove(const Layout::BottomUp& bu, const std::string& input)
+	{
+		Clock::time_point start { Clock::now()};
+		Layout::BottomUp copy(bu);
+		report("BottomUp copy", input, copy.groups.size(), elapsedMs(start));
+		// one NodeMap per repeated non terminal uid
+		std::vector<Layout::NodeMap> removals;
+		for (Layout::uIDType u {0}; u < copy.next; ++u)
+		{
+			Layout::GroupMapIt pr { copy.groups.equal_range(u)};
+			if (pr.first == pr.second || pr.first ->second.first ->terminal()) {
+				continue;
+			}
+			Layout::NodeMap nMap;
+			for (; pr.first != pr.second; ++pr.first)
+			{
+				nMap.insert(std::make_pair(u, pr.first ->second.first));
+			}
+			if (nMap.size() > 1) {
+				removals.push_back(std::move(nMap));
+			}
+		}
+		unsigned long removed {0};
+		start = Clock::now();
+		for (Layout::NodeMap& nMap : removals)
+		{
+			removed += nMap.size();
+			copy.removeNodes(nMap);
+		}
+		report("removeNodes", input, removed, elapsedMs(start));
+	}
+	/*********************************************************************************************
+	 * collectSplitLines adds one GroupPair and split iterator for every split line of the
+	 * 		location tree under loc.
+	 *********************************************************************************************/
+	void collectSplitLines(const Layout::GroupPair& loc,
+			std::vector<std::pair<Layout::GroupPair, Layout::SplitIt>>& lines)
+	{
+		Layout::Vector childMin { loc.second};
+		for (std::vector<Layout::Scalar>::size_type i {0}; i < loc.first ->children.size(); ++i)
+		{
+			if (i > 0) {
+				lines.push_back(std::make_pair(loc, loc.first ->splits.begin() + (i - 1)));
+				if (loc.first ->splitDir == Layout::Vector::Axis::X) {
+					childMin.x = loc.second.x + loc.first ->splits[i - 1];
+				}
+				else {
+					childMin.y = loc.second.y + loc.first ->splits[i - 1];
+				}
+			}
+			collectSplitLines(Layout::GroupPair(loc.first ->children[i], childMin), lines);
+		}
+	}
+	/*********************************************************************************************
+	 * benchFrozenSplits freezes the BottomUp of filename and evaluates the cost of every
+	 * 		split line of the location tree, first on one thread and then spread
+	 * 		over all the hardware threads, with no locks.  xmltest checks the
+	 * 		costs against allSplitGroups.
+	 *********************************************************************************************/
+	void benchFrozenSplits(const char* filename, const std::string& input, unsigned iterations)
+	{
+		std::unique_ptr<Layout::BottomUp> bu { new Layout::BottomUp(filename)};
+		Clock::time_point start { Clock::now()};
+		Layout::FrozenBottomUp frozen(std::move(bu));
+		report("freeze", input, frozen.groups().size(), elapsedMs(start));
+		std::vector<std::pair<Layout::GroupPair, Layout::SplitIt>> lines;
+		collectSplitLines(frozen.location(), lines);
+		std::vector<Layout::NodeMap::size_type> serial(lines.size()), parallel(lines.size());
+		start = Clock::now();
+		for (unsigned it {0}; it < iterations; ++it)
+		{
+			for (std::vector<Layout::NodeMap::size_type>::size_type i {0}; i < lines.size(); ++i)
+			{
+				Layout::LineSegment line(lines[i].first, lines[i].second);
+				serial[i] = frozen.splitCost(lines[i].first, line);
+			}
+		}
+		report("splitCost", input, lines.size() * iterations, elapsedMs(start));
+		unsigned threads { std::max(2u, std::thread::hardware_concurrency())};
+		start = Clock::now();
+		std::vector<std::thread> pool;
+		for (unsigned t {0}; t < threads; ++t)
+		{
+			pool.push_back(std::thread([&frozen, &lines, &parallel, t, threads, iterations]()
+				{
+					for (unsigned it {0}; it < iterations; ++it)
+					{
+						for (std::vector<Layout::NodeMap::size_type>::size_type i {t}; i < lines.size();
+								i += threads)
+						{
+							Layout::LineSegment line(lines[i].first, lines[i].second);
+							parallel[i] = frozen.splitCost(lines[i].first, line);
+						}
+					}
+				}));
+		}
+		for (std::thread& thread : pool)
+		{
+			thread.join();
+		}
+		report("splitCost " + std::to_string(threads) + " threads", input, lines.size() * iterations,
+				elapsedMs(start));
+		sink += static_cast<unsigned long>(serial == parallel);
+	}
+	/*********************************************************************************************
+	 * benchRepeatRuns times addRepeatedRuns and addRepeatedTiles, each over the
+	 * 		terminals alone.
+	 *********************************************************************************************/
+	void benchRepeatRuns(const char* filename, const std::string& input)
+	{
+		Layout::BottomUp bu(filename, 0);
+		Clock::time_point start { Clock::now()};
+		unsigned added { bu.addRepeatedRuns(3)};
+		report("addRepeatedRuns(3)", input, added, elapsedMs(start));
+		Layout::BottomUp tiled(filename, 0);
+		start = Clock::now();
+		added = tiled.addRepeatedTiles();
+		report("addRepeatedTiles", input, added, elapsedMs(start));
+	}
+	// prints count allocations over iterations loads as allocations per load
+	void reportAllocations(const std::string& name, const std::string& input, unsigned long count,
+			unsigned iterations)
+	{
+		printf("%-26s %-22s %10.1f allocations/load\n", name.c_str(), input.c_str(),
+				static_cast<double>(count) / iterations);
+	}
+	/*********************************************************************************************
+	 * benchLoad times reading and parsing the file with LoadFile, with LoadFileMapped and
+	 * 		with LoadFile into one document that is Reset() between loads, and
+	 * 		counts the allocations of each.  The reused document is loaded once
+	 * 		before it is timed, so it shows the steady state of a batch.
+	 *********************************************************************************************/
+	void benchLoad(const char* filename, const std::string& input, unsigned iterations)
+	{
+		unsigned long before {allocations};
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			tinyxml2::XMLDocument doc;
+			doc.LoadFile(filename);
+			sink += static_cast<unsigned long>(doc.ErrorID());
+		}
+		double ms {elapsedMs(start)};
+		unsigned long count {allocations - before};
+		report("LoadFile", input, iterations, ms);
+		reportAllocations("LoadFile", input, count, iterations);
+		before = allocations;
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			tinyxml2::XMLDocument doc;
+			doc.LoadFileMapped(filename);
+			sink += static_cast<unsigned long>(doc.ErrorID());
+		}
+		ms = elapsedMs(start);
+		count = allocations - before;
+		report("LoadFileMapped", input, iterations, ms);
+		reportAllocations("LoadFileMapped", input, count, iterations);
+		tinyxml2::XMLDocument reused;
+		reused.LoadFile(filename);
+		before = allocations;
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			reused.Reset();
+			reused.LoadFile(filename);
+			sink += static_cast<unsigned long>(reused.ErrorID());
+		}
+		ms = elapsedMs(start);
+		count = allocations - before;
+		report("LoadFile after Reset", input, iterations, ms);
+		reportAllocations("LoadFile after Reset", input, count, iterations);
+	}
+	/*********************************************************************************************
+	 * benchFacade runs every Layout benchmark over one facade file.
+	 *********************************************************************************************/
+	void benchFacade(const char* filename, unsigned iterations)
+	{
+		std::string input { baseName(filename)};
+		tinyxml2::XMLDocument doc;
+		doc.LoadFile(filename);
+		if (doc.ErrorID() != tinyxml2::XML_SUCCESS) {
+			printf("failed to load %s\n", filename);
+			exit(1);
+		}
+		benchLoad(filename, input, iterations);
+		benchBoundBox(doc, input, iterations);
+		benchNameLookup(doc, input, iterations);
+		benchLocationTree(filename, input, iterations);
+		std::unique_ptr<Layout::BottomUp> bu { benchAddNTGroups(filename, input, true)};
+		benchLocation(*bu, input, iterations);
+		benchFrozenSplits(filename, input, iterations);
+		benchCopyAndRemove(*bu, input);
+		benchRepeatRuns(filename, input);
+	}
+	/*********************************************************************************************
+	 * benchSyntheticBoundBox times BoundBox parsing over a generated document of
+	 * 		count BBox elements.
+	 *********************************************************************************************/
+	void benchSyntheticBoundBox(unsigned count, unsigned iterations)
+	{
+		std::mt19937 gen(660);
+		std::uniform_real_distribution<float> dist(0.f, 1.f);
+		std::ostringstream xml;
+		xml.precision(9);
+		xml << "<Boxes>";
+		for (unsigned i {0}; i < count; ++i)
+		{
+			float x { dist(gen)}, y { dist(gen)}, w { dist(gen)}, h { dist(gen)};
+			xml << "<BBox><Min><X>" << x << "</X><Y>" << y << "</Y><Z>0</Z></Min>"
+			    << "<Max><X>" << x + w << "</X><Y>" << y + h << "</Y><Z>0.3</Z></Max>"
+			    << "<Size><X>" << w << "</X><Y>" << h << "</Y><Z>0.3</Z></Size></BBox>";
+		}
+		xml << "</Boxes>";
+		tinyxml2::XMLDocument doc;
+		doc.Parse(xml.str().c_str());
+		std::vector<const tinyxml2::XMLNode*> boxes;
+		collectBBoxes(&doc, boxes);
+		const Layout::ShapeNames xmlNames(doc);
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+		{
+			for (const tinyxml2::XMLNode* box : boxes)
+			{
+				Layout::BoundBox bb(box, xmlNames);
+				sink += static_cast<unsigned long>(float(bb.size().x) != 0.f);
+			}
+		}
+		report("BoundBox parse", "synthetic " + std::to_string(count),
+				boxes.size() * iterations, elapsedMs(start));
+	}
+	/*********************************************************************************************
+	 * benchScalar times the arithmetic and comparison of one Layout scalar policy S over
+	 * 		count synthetic values.  Every policy is timed whichever one the build
+	 * 		picked as Layout::Scalar.
+	 *********************************************************************************************/
+	template<typename S> void benchScalar(const std::string& name, unsigned count, unsigned iterations)
+	{
+		std::mt19937 gen(660);
+		std::uniform_real_distribution<float> dist(0.01f, 1.f);
+		std::vector<S> a, b;
+		for (unsigned i {0}; i < count; ++i)
+		{
+			a.push_back(Layout::ScalarInput<S>::read(dist(gen)));
+			b.push_back(Layout::ScalarInput<S>::read(dist(gen)));
+		}
+		std::string input { "synthetic " + std::to_string(count)};
+		unsigned long ops { static_cast<unsigned long>(count) * iterations};
+		float acc {0.f};
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				acc += float(a[j] + b[j]);
+		report(name + " +", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				acc += float(a[j] - b[j]);
+		report(name + " -", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				acc += float(a[j] * b[j]);
+		report(name + " *", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				acc += float(a[j] / b[j]);
+		report(name + " /", input, ops, elapsedMs(start));
+		unsigned long hits {0};
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				hits += (a[j] < b[j]);
+		report(name + " <", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				hits += (a[j] == b[j]);
+		report(name + " ==", input, ops, elapsedMs(start));
+		sink += hits + static_cast<unsigned long>(acc);
+	}
+	/*********************************************************************************************
+	 * benchIntervalBatch times Efloat +, * and the child corners one value at a time
+	 * 		and then as IntervalBatch kernels.  xmltest checks both give the same
+	 * 		bits.
+	 *********************************************************************************************/
+	void benchIntervalBatch(unsigned count, unsigned iterations)
+	{
+		std::mt19937 gen(660);
+		std::uniform_real_distribution<float> dist(0.01f, 1.f);
+		std::vector<Efloat> a, b, out(count);
+		for (unsigned i {0}; i < count; ++i)
+		{
+			a.push_back(Layout::ScalarInput<Efloat>::read(dist(gen)));
+			b.push_back(Layout::ScalarInput<Efloat>::read(dist(gen)));
+		}
+		Layout::IntervalBatch ab(a), bb(b), ob;
+		std::string input { "synthetic " + std::to_string(count)};
+		std::string path { Layout::intervalKernelPath()};
+		unsigned long ops { static_cast<unsigned long>(count) * iterations};
+		Clock::time_point start { Clock::now()};
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				out[j] = a[j] + b[j];
+		report("Efloat + each", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			Layout::add(ab, bb, ob);
+		report("batch + " + path, input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				out[j] = a[j] * b[j];
+		report("Efloat * each", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			Layout::multiply(ab, bb, ob);
+		report("batch * " + path, input, ops, elapsedMs(start));
+		// the corners of count children from a corner and sorted splits
+		std::vector<Efloat> splits;
+		Efloat at;
+		for (unsigned j {0}; j < count; ++j)
+		{
+			at = at + a[j];
+			splits.push_back(at);
+		}
+		Layout::IntervalBatch sb(splits);
+		Efloat corner { Layout::ScalarInput<Efloat>::read(3.f)};
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (unsigned j {0}; j < count; ++j)
+				out[j] = corner + splits[j];
+		report("corners each", input, ops, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			Layout::offset(corner, sb, ob);
+		report("corners batch " + path, input, ops, elapsedMs(start));
+		// the child that holds each of 64 coordinates along the splits
+		std::vector<Efloat> xs;
+		for (unsigned j {0}; j < 64; ++j)
+		{
+			xs.push_back(Efloat(dist(gen) * float(at)));
+		}
+		std::vector<float> lows;
+		for (const Efloat& split : splits)
+		{
+			lows.push_back(split.lowerBound());
+		}
+		unsigned long found {0}, counted {0};
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (const Efloat& x : xs)
+				found += std::upper_bound(splits.cbegin(), splits.cend(), x) - splits.cbegin();
+		report("upper_bound", input, xs.size() * iterations, elapsedMs(start));
+		start = Clock::now();
+		for (unsigned i {0}; i < iterations; ++i)
+			for (const Efloat& x : xs)
+				counted += Layout::countNotAbove(lows, x);
+		report("countNotAbove " + path, input, xs.size() * iterations, elapsedMs(start));
+		sink += found + counted;
+	}
+}
+
+int main(int argc, const char ** argv)
+{
+	unsigned iterations {10};
+	bool buildOnly {false};
+	std::vector<std::string> files;
+	for (int i {1}; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			iterations = static_cast<unsigned>(std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--build-only") == 0) {
+			buildOnly = true;
+		}
+		else {
+			files.push_back(argv[i]);
+		}
+	}
+	printf("%-26s %-22s %10s %15s %18s\n", "benchmark", "input", "ops", "total", "per op");
+	if (buildOnly) {
+		for (const std::string& file : files)
+		{
+			benchAddNTGroups(file.c_str(), baseName(file), false);
+		}
+		return 0;
+	}
+	if (files.empty()) {
+		files.push_back("resources/Layout.xml");
+		files.push_back("resources/NR07031_basic.xml");
+		// a 6 x 8 periodic grid, two levels of nesting
+		Layout::SyntheticFacade grid;
+		grid.rows = 6;
+		grid.cols = 8;
+		grid.depth = 2;
+		files.push_back("resources/out/synthetic_6x8.xml");
+		Layout::writeSyntheticFacade(grid, files.back());
+		// one long bay of 24 single windows, two storeys
+		Layout::SyntheticFacade bay;
+		bay.rows = 2;
+		bay.cols = 24;
+		bay.tileRows = 1;
+		bay.tileCols = 1;
+		files.push_back("resources/out/synthetic_bay.xml");
+		Layout::writeSyntheticFacade(bay, files.back());
+	}
+	for (const std::string& file : files)
+	{
+		benchFacade(file.c_str(), iterations);
+	}
+	benchSyntheticBoundBox(1000, iterations);
+	benchScalar<Efloat>("Efloat", 1 << 16, iterations);
+	benchScalar<Layout::EpsFloat>("EpsFloat", 1 << 16, iterations);
+	benchScalar<Layout::FixedScalar>("FixedScalar", 1 << 16, iterations);
+	benchIntervalBatch(1 << 16, iterations);
+	// a typical node has a handful of splits
+	benchIntervalBatch(16, iterations * 4096);
+	return 0;
+}
@@ -1,8 +1,24 @@
 //define NDEBUG
 #include <assert.h>
 #include "parseLayout.h"
+#include "suffixRepeats.h"
+#include "tileRepeats.h"
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+using Layout::Scalar;
+using Layout::Vector;
+// every LAYOUT_AUDIT_PERIOD checked mutations walk the whole location tree.
+// 0 only checks the nodes each mutation touches.
+#ifndef LAYOUT_AUDIT_PERIOD
+#define LAYOUT_AUDIT_PERIOD 0
+#endif
+// defined below; the Layout templates call them on types of namespace Layout
+template<typename T> Layout::SplitItPair  findOverlappingSplits(Layout::GroupPair loc, const T& line);
+template<typename T> Layout::ChildItPair  findOverlappingChildren(Layout::GroupPair loc, T& child);
 
 namespace Layout {
 	/* ******************************************************************************************************************
@@ -14,7 +30,7 @@ namespace Layout {
 		// minMap x, y dimensions of spatial Node bounding box
 		minMaxPr xLocPr, yLocPr;
 		// axis of GroupNode
-		EVector::Axis splitDir;
+		Vector::Axis splitDir;
 	public:
 		// initialize all variables
 		LineBasics(const GroupPair& StartLocation);
@@ -33,9 +49,9 @@ namespace Layout {
 		bool operator()(const minMaxPr pr) const;
 		// determines whether a splitline verlaps with current
 		// NTgroup.  The splitLine is within StartLocation group
-		bool operator()(const Efloat& splitLine) const;
+		bool operator()(const Scalar& splitLine) const;
 		// returns current Axis
-		EVector::Axis axis() const;
+		Vector::Axis axis() const;
 	};
 	/* ******************************************************************************************************************
 	 * LineIntersects tests if a splitLine within a spatialLocation GroupPair splits a
@@ -64,7 +80,7 @@ namespace Layout {
 		bool operator()(const minMaxPr pr) const;
 		// determines whether a splitline verlaps with current
 		// NTgroup.  The splitLine is within StartLocation group
-		bool operator()(const Efloat& splitLine) const;
+		bool operator()(const Scalar& splitLine) const;
 	};
 	// determine if a LineSegment overlaps with any splitline in the
 	// BranchNode.  Also given a LineSegment and a GroupNode will determine
@@ -95,7 +111,7 @@ namespace Layout {
 			// splitDir true means that should could contain an Overlap line
 			bool operator()(const Layout::minMaxPr pr) const; 
 			// true if the splitline overlaps the stored line
-			bool operator()(const Efloat& splitLine) const;
+			bool operator()(const Scalar& splitLine) const;
 	};
 	/*******************************************************************************************************************
 	 *      @func findContainingParent will find the branch Node that contains the
@@ -115,7 +131,7 @@ namespace Layout {
 			return currentLoc;
 		}
 		// no so check parent. initialize with child location.
-		EVector parentLoc { currentLoc.second};
+		Vector parentLoc { currentLoc.second};
 		// parent is null
 		if ( currentLoc.first->parent.expired() ||  currentLoc.first->parent.lock() == nullptr)
 		{
@@ -153,11 +169,11 @@ namespace Layout {
 		ChildItPair childrenPairs { findOverlappingChildren( currentLoc, line)};
 		std::ptrdiff_t  diff { childrenPairs.first - currentLoc.first ->children.begin()};
 		// first child of currentLoc.first is an overlapping child
-		std::vector<Efloat>::size_type indx {0};
-		EVector childMin {currentLoc.second};
+		std::vector<Scalar>::size_type indx {0};
+		Vector childMin {currentLoc.second};
 		if (diff > 0 && diff < static_cast<std::ptrdiff_t>(currentLoc.first ->children.size())) {
 			indx = diff - 1;
-			if (line.axis() == EVector::Axis::X)
+			if (line.axis() == Vector::Axis::X)
 			{
 				childMin.x = currentLoc.second.x + currentLoc.first ->splits[indx++];
 			}
@@ -165,7 +181,7 @@ namespace Layout {
 				childMin.y = currentLoc.second.y + currentLoc.first ->splits[indx++];
 			}
 		}
-		if ( line.axis() == EVector::Axis::X)
+		if ( line.axis() == Vector::Axis::X)
 		{
 			for (; childrenPairs.first < childrenPairs.second; ++childrenPairs.first )
 			{ 
@@ -193,6 +209,52 @@ namespace Layout {
 			}
 		}
 	}
+	/******************************************************************************************************************
+	 *      @func coveringNode walks up the location tree from node to the first node
+	 *      	that covers all the terminals in terms.  It plays the part of
+	 *      	findContainingParent for a group given by its terminals.
+	 *	*********************************************************************************************************/
+	std::shared_ptr<const Node> coveringNode(std::shared_ptr<const Node> node, const TermSet& terms)
+	{
+		while (!node -> terms.contains(terms))
+		{
+			std::shared_ptr<const Node> parent {node -> parent.lock()};
+			if (parent == nullptr)
+			{
+				throw std::runtime_error("Parent expired or not large enough for this group");
+			}
+			node = parent;
+		}
+		return node;
+	}
+	/******************************************************************************************************************
+	 *      @func branchesSplittingTerms finds the same branches and splitlines as
+	 *      	branchesWithOverlappingSplit, using the terminals instead of the
+	 *      	geometry.  The children of node that share terminals with the
+	 *      	group are consecutive and the splits between the first and the
+	 *      	last of them cut the group.
+	 *	@params[in]  node   the node from coveringNode, or one of its descendents
+	 *	             terms  the terminals of the NonTerminal group
+	 *	           vector<BranchSplitPairs> all the splitlines that cut the group
+	 *	*********************************************************************************************************/
+	void branchesSplittingTerms(std::shared_ptr<const Node> node, const TermSet& terms,
+			             std::vector<BranchSplitPair>& splits )
+	{
+		auto shares {[&terms](const std::shared_ptr<const Node>& child) -> bool
+			{
+				return child -> terms.intersects(terms);
+			}};
+		ChildIt first { std::find_if(node -> children.begin(), node -> children.end(), shares)};
+		ChildIt last { std::find_if_not(first, node -> children.end(), shares)};
+		if (last - first > 1) {
+			SplitIt split {node -> splits.begin() + (first - node -> children.begin())};
+			splits.push_back(BranchSplitPair(node, SplitItPair(split, split + (last - first - 1))));
+		}
+		for (; first != last; ++first)
+		{
+			branchesSplittingTerms(*first, terms, splits);
+		}
+	}
 }
 /**************************************************************************************************************************
  * WeakCompare will compare weak_ptr<const Node>
@@ -234,68 +296,80 @@ tinyxml2::XMLNode* Layout::getMainShape(tinyxml2::XMLDocument* doc)
 	FirstChildElement("MainShape");
 }
 /*  Parses a list of siblings as floats*/
-std::vector<Efloat> parseList(const tinyxml2::XMLNode * node, Efloat min)
+std::vector<Scalar> parseList(const tinyxml2::XMLNode * node, Scalar min)
 {
-	const tinyxml2::XMLNode * val = node ->FirstChild();
-	std::vector<Efloat> vals;
-	while ( val != nullptr)
+	const tinyxml2::XMLElement * list = node ->ToElement();
+	std::vector<Scalar> vals;
+	if (list == nullptr) return vals;
+	int n {0};
+	for (const tinyxml2::XMLNode * val = node ->FirstChild(); val != nullptr; val = val ->NextSibling())
 	{
-		float x;
-		const tinyxml2::XMLElement * elem = val ->ToElement();
-		if (elem == nullptr) break;
-		tinyxml2::XMLError err = elem ->QueryFloatText(&x);
-		if (err != tinyxml2::XML_SUCCESS) break;
-		vals.push_back(Efloat(x, 6e-7f, Efloat::Normal) - min);
-		val = val -> NextSibling();
+		++n;
+	}
+	// reads up to the first child that is not a float
+	std::vector<float> xs(n);
+	xs.resize(list ->QueryFloatChildTexts(xs.data(), n));
+	vals.reserve(xs.size());
+	for (float x : xs)
+	{
+		vals.push_back(Layout::toScalar(x) - min);
 	}
 	std::sort(vals.begin(), vals.end());
 	return vals;
 }
 
-EVector getPosition(const tinyxml2::XMLNode * node)
+Vector getPosition(const tinyxml2::XMLNode * node, const Layout::ShapeNames& xmlNames)
 {
 	float xval;
 	float yval;
 	float zval;
-	const tinyxml2::XMLElement* elem = node->FirstChildElement("X");
+	const tinyxml2::XMLElement* elem = node->FirstChildElement(xmlNames.x);
 	tinyxml2::XMLError err = elem ->QueryFloatText(&xval);
 	if (err != tinyxml2::XML_SUCCESS)
 	{
 		throw std::runtime_error("failed X Conversion");
 	}
-	elem = node->FirstChildElement("Y");
+	elem = node->FirstChildElement(xmlNames.y);
 	err = elem->QueryFloatText(&yval);
 	if (err != tinyxml2::XML_SUCCESS)
 	{
 		throw std::runtime_error("failed Y Conversion");
 	}
-	elem = node->FirstChildElement("Z");
+	elem = node->FirstChildElement(xmlNames.z);
 	err = elem->QueryFloatText(&zval);
 	if (err != tinyxml2::XML_SUCCESS)
 	{
 		throw std::runtime_error("failed Z Conversion");
 	}
-	Efloat xE(xval, 6e-7f, Efloat::Normal);
-	Efloat yE(yval, 6e-7f, Efloat::Normal);
-	Efloat zE(zval, 6e-7f, Efloat::Normal);
-	return EVector(xE, yE, zE);
+	return Layout::Vector(Layout::toScalar(xval), Layout::toScalar(yval), Layout::toScalar(zval));
 }
+Layout::ShapeNames::ShapeNames(const tinyxml2::XMLDocument& doc):
+	bbox{doc.FindName("BBox")}, min{doc.FindName("Min")}, max{doc.FindName("Max")},
+	size{doc.FindName("Size")}, x{doc.FindName("X")}, y{doc.FindName("Y")}, z{doc.FindName("Z")},
+	children{doc.FindName("Children")}, level{doc.FindName("Level")}, uid{doc.FindName("UId")},
+	isolated{doc.FindName("Isolated")}, label{doc.FindName("Label")},
+	labelName{doc.FindName("LabelName")}, splitsX{doc.FindName("SplitsX")},
+	splitsY{doc.FindName("SplitsY")}
+{}
 Layout::BoundBox::BoundBox(){}
-Layout::BoundBox::BoundBox(EVector minV, EVector maxV)
+Layout::BoundBox::BoundBox(Vector minV, Vector maxV)
 {
 	minVal = minV;
 	maxVal = maxV;
 	sizeV = maxV - minV;
 
 }
-Layout::BoundBox::BoundBox(const tinyxml2::XMLNode* node)
+Layout::BoundBox::BoundBox(const tinyxml2::XMLNode* node):
+	BoundBox(node, ShapeNames(*node->GetDocument()))
+{}
+Layout::BoundBox::BoundBox(const tinyxml2::XMLNode* node, const ShapeNames& xmlNames)
 {
-	const tinyxml2::XMLNode * pos = node->FirstChildElement("Min");
-	minVal = getPosition(pos);
-	pos = node->FirstChildElement("Max");
-	maxVal = getPosition(pos);
-	pos = node->FirstChildElement("Size");
-	sizeV = getPosition(pos);
+	const tinyxml2::XMLNode * pos = node->FirstChildElement(xmlNames.min);
+	minVal = getPosition(pos, xmlNames);
+	pos = node->FirstChildElement(xmlNames.max);
+	maxVal = getPosition(pos, xmlNames);
+	pos = node->FirstChildElement(xmlNames.size);
+	sizeV = getPosition(pos, xmlNames);
 	if (!(sizeV + minVal == maxVal))
 	{
 		throw std::runtime_error("size not consistent");
@@ -305,33 +379,49 @@ bool Layout::NodeValue::terminal() const
 {
 	return n == 1;
 }
+bool Layout::NodeValue::built() const
+{
+	return llGroup != std::numeric_limits<uIDType>::max();
+}
+std::string Layout::NodeValue::label() const
+{
+	if (!built()) {
+		return name;
+	}
+	std::ostringstream ss;
+	ss << "Terms : " << n;
+	ss << "; groups : " << llGroup;
+	ss << " & " << neighbor;
+	ss << ((joinAxis == Vector::Axis::X) ? " X" : " Y");
+	return ss.str();
+}
 bool Layout::Node::terminal() const
 {	
 	return v -> terminal();
 }
-const EVector&  Layout::BoundBox::min() const
+const Vector&  Layout::BoundBox::min() const
 {
 		return minVal;
 }
-const EVector&  Layout::BoundBox::max() const
+const Vector&  Layout::BoundBox::max() const
 {
 		return maxVal;
 }
-const EVector&  Layout::BoundBox::size() const
+const Vector&  Layout::BoundBox::size() const
 {
 	       return sizeV;
 }
 
-Layout::Node::Node(const EVector& sz, const EVector::Axis sd, 
-		                std::vector<Efloat>&& ss, 
+Layout::Node::Node(const Vector& sz, const Vector::Axis sd, 
+		                std::vector<Scalar>&& ss, 
 				std::weak_ptr<const Node> p,
                                 std::shared_ptr<NodeValue> vd) : v{vd},
 					size{sz}, splitDir{sd}, 
-					splits{std::move(ss)},
+					splits{std::move(ss)}, splitIndex{splits},
 					parent{p}
 {}
 // Branch Nodes always have nonempty splits
-Layout::BranchNode::BranchNode(const EVector& sz, const EVector::Axis sd, std::vector<Efloat>&& ss,
+Layout::BranchNode::BranchNode(const Vector& sz, const Vector::Axis sd, std::vector<Scalar>&& ss,
 					std::weak_ptr<const Node> p, std::shared_ptr<NodeValue> v ):
 					Node(sz, sd, std::move(ss),  p, v), splitGroups{std::vector<WeakMap>(splits.size())}
 {}
@@ -390,7 +480,7 @@ bool  strictlyOverlap( const Layout::minMaxPr a, const Layout::minMaxPr b)
 
 // strictly Overlap is true only if b falls within a and is not on
 // the boundary
-bool  strictlyOverlap( const Layout::minMaxPr a, const Efloat b)
+bool  strictlyOverlap( const Layout::minMaxPr a, const Scalar b)
 {
 	bool overlaps {a.first < b &&  b < a.second};
 	return overlaps;
@@ -461,20 +551,20 @@ bool Layout::LineBasics::operator()(const Layout::minMaxPr pr) const
 		}
 bool Layout::LineIntersects::operator()(const Layout::minMaxPr pr) const 
 		{
-			return  (splitDir == EVector::Axis::X) ? 
+			return  (splitDir == Vector::Axis::X) ? 
 				strictlyOverlap(pr, xGroup) : strictlyOverlap(pr, yGroup);
 		}
-bool Layout::LineBasics::operator()(const Efloat& splitLine) const
+bool Layout::LineBasics::operator()(const Scalar& splitLine) const
 		{
 		      return false;
 		}
-bool Layout::LineIntersects::operator()(const Efloat& splitLine) const
+bool Layout::LineIntersects::operator()(const Scalar& splitLine) const
 		{
-		      return (splitDir == EVector::Axis::X)? 
+		      return (splitDir == Vector::Axis::X)? 
 			      strictlyOverlap(xGroup, xLocPr.first + splitLine):
 			      strictlyOverlap(yGroup, yLocPr.first + splitLine);
 		}
-EVector::Axis  Layout::LineBasics::axis() const
+Vector::Axis  Layout::LineBasics::axis() const
 {
 	return splitDir;
 }
@@ -496,7 +586,7 @@ void Layout::LineOverlapsLine::updateSearchCorner(Layout::GroupPair& loc)
 bool Layout::LineOverlapsLine::anyOverlaps() const
 {
 	bool Overlaps;
-	if (line.ax == EVector::Axis::X)
+	if (line.ax == Vector::Axis::X)
 	{ 
 		Overlaps = strictlyOverlap( yLocPr, line.transverseVal);
 		Overlaps = Overlaps && strictlyOverlap(xLocPr, line.pr);
@@ -511,7 +601,7 @@ bool Layout::LineOverlapsLine::anyOverlaps() const
 bool Layout::LineOverlapsLine::groupWithinLocation() const 
 {
 	bool Overlaps;
-	if (line.ax == EVector::Axis::X)
+	if (line.ax == Vector::Axis::X)
 	{ 
 		Overlaps = strictlyOverlap( yLocPr, line.transverseVal);
 		Overlaps = Overlaps && containedWithin(xLocPr, line.pr);
@@ -529,13 +619,13 @@ bool Layout::LineOverlapsLine::operator()(const Layout::minMaxPr pr) const
 			strictlyOverlap(pr, line.pr);
 }
 // true if the splitline overlaps the stored line
-bool Layout::LineOverlapsLine::operator()(const Efloat& splitLine) const
+bool Layout::LineOverlapsLine::operator()(const Scalar& splitLine) const
 {
 	// if not aligned, the stored line and the splits are perpendicular.
 	// No split lines can equal.
 	bool overlap {false};
 	if (aligned) {
-		Efloat val {(splitDir == EVector::Axis::X)? xLocPr.first : yLocPr.first};
+		Scalar val {(splitDir == Vector::Axis::X)? xLocPr.first : yLocPr.first};
 		val +=splitLine;
 		overlap = (val == line.transverseVal);
 	}
@@ -591,10 +681,10 @@ template<typename T> Layout::ChildItPair  findOverlappingChildren(Layout::GroupP
 	if ( loc.first ->children.size() == 0){
 		return pr;
 	}
-	Efloat prior { (loc.first -> splitDir == EVector::Axis::X) ?  
+	Scalar prior { (loc.first -> splitDir == Vector::Axis::X) ?  
 	        loc.second.x : loc.second.y};
-	Efloat minVal { prior};
-	Efloat maxVal { (loc.first -> splitDir == EVector::Axis::X) ?  
+	Scalar minVal { prior};
+	Scalar maxVal { (loc.first -> splitDir == Vector::Axis::X) ?  
 	        loc.first -> size.x : loc.first -> size.y};
 	Layout::ChildIt start { loc.first ->children.begin()};
 	pr.first = start;
@@ -602,7 +692,7 @@ template<typename T> Layout::ChildItPair  findOverlappingChildren(Layout::GroupP
 	for (; pr.first < last; ++pr.first)
 	{
 		std::vector<int>::size_type t = static_cast<std::vector<int>::size_type> (pr.first - start);
-		Efloat second { (t  < loc.first -> children.size() - 1) ? 
+		Scalar second { (t  < loc.first -> children.size() - 1) ? 
 			         loc.first -> splits[t]: maxVal}; 
 		Layout::minMaxPr prOverlap {prior,  minVal + second};
 		bool overlaps { child(prOverlap)};
@@ -617,7 +707,7 @@ template<typename T> Layout::ChildItPair  findOverlappingChildren(Layout::GroupP
 	{
 		std::vector<int>::size_type t = static_cast<std::vector<int>::size_type> 
 			      (pr.second - start);
-		Efloat second { (t  < loc.first -> children.size() - 1) ? 
+		Scalar second { (t  < loc.first -> children.size() - 1) ? 
 			         loc.first -> splits[t]: maxVal}; 
 		Layout::minMaxPr prOverlap {prior,  minVal + second};
 		bool overlaps { child(prOverlap)};
@@ -634,12 +724,12 @@ template<typename T> Layout::ChildItPair  findOverlappingChildren(Layout::GroupP
 // non terminal group to insert into the splitlines
 void Layout::addNTGroupToSplitLines(Layout::GroupPair ll, Layout::GroupPair ntGroup)
 {
-	// get the line intersects class to determine overlaps and split lines 
-	Layout::LineIntersects  line( ll, ntGroup);
-	Layout::GroupPair  parent {Layout::findContainingParent(ll, line)};
+	// the terminals of the group find the split lines; testAddingNodes
+	// still checks them against the geometry of LineIntersects
+	std::shared_ptr<const Node> parent {Layout::coveringNode(ll.first, ntGroup.first -> terms)};
 	std::vector<Layout::BranchSplitPair> splits;
 	// find all the split lines
-	Layout::branchesWithOverlappingSplit(parent, line, splits);
+	Layout::branchesSplittingTerms(parent, ntGroup.first -> terms, splits);
 	for ( Layout::BranchSplitPair pr : splits)
 	{
 		std::shared_ptr<const Layout::BranchNode> br { 
@@ -661,13 +751,8 @@ void insertIntoNodeMap( Layout::NodeMap& nm,  std::shared_ptr<const Layout::Node
 		} };
 	Layout::NodeMapItPr nmIt {nm.equal_range(thisNode ->v -> uid)};
 	Layout::NodeMapIt foundIt { std::find_if(nmIt.first, nmIt.second, lam)};
-	if (foundIt != nmIt.second) {
+	if (foundIt == nmIt.second) {
 		nm.insert(std::make_pair(thisNode->v ->uid, thisNode));
-		foundIt = std::find_if( ++nmIt.first, nmIt.second, lam);
-		if (foundIt !=nmIt.second) {
-			throw std::runtime_error("found twice in nodeMap");
-		}
-
 	}
 }
 /******************************************************************************
@@ -729,7 +814,7 @@ Layout::NodeMap Layout::allSplitGroups(Layout::GroupPair ll, Layout::LineSegment
 	{ 
 		addSplitsToNodeMap(nodes, pr);
 	}
-	return  Layout::NodeMap();
+	return  nodes;
 }
 
 /******************************************************************************************************************
@@ -749,6 +834,108 @@ void Layout::addToNodeMaps(Layout::NodeMap& sum, const Layout::NodeMap& b)
 
 
 
+Layout::FrozenBottomUp::FrozenBottomUp(std::unique_ptr<BottomUp> in): bu{std::move(in)}
+{
+	freeze(bu -> location.first);
+}
+
+void Layout::FrozenBottomUp::freeze(const std::shared_ptr<const Node>& node)
+{
+	if (const LeafNode* leaf = dynamic_cast<const LeafNode*>(node.get())) {
+		std::vector<Corner>& corner { corners[leaf]};
+		for (const std::pair<const Scalar, YWidth>& xWidth : leaf -> LL)
+		{
+			for (const std::pair<const Scalar, std::weak_ptr<const Node>>& yWidth : xWidth.second)
+			{
+				std::shared_ptr<const Node> group {yWidth.second.lock()};
+				if (group == nullptr) {
+					throw std::runtime_error("Expired Group in Location Map");
+				}
+				corner.push_back(Corner{xWidth.first, yWidth.first, group});
+			}
+		}
+	}
+	else if (const BranchNode* branch = dynamic_cast<const BranchNode*>(node.get())) {
+		std::vector<std::vector<std::shared_ptr<const Node>>>& lines { splitGroups[branch]};
+		lines.resize(branch -> splitGroups.size());
+		for (std::vector<WeakMap>::size_type i {0}; i < branch -> splitGroups.size(); ++i)
+		{
+			for (const auto& split : branch -> splitGroups[i])
+			{
+				std::shared_ptr<const Node> group {split.second.lock()};
+				if (group == nullptr) {
+					throw std::runtime_error("expired Node is split");
+				}
+				lines[i].push_back(group);
+			}
+		}
+	}
+	for (const std::shared_ptr<const Node>& child : node -> children)
+	{
+		freeze(child);
+	}
+}
+
+const Layout::GroupPair& Layout::FrozenBottomUp::location() const
+{
+	return bu -> location;
+}
+
+const Layout::GroupMap& Layout::FrozenBottomUp::groups() const
+{
+	return bu -> groups;
+}
+
+const Layout::nameMap& Layout::FrozenBottomUp::names() const
+{
+	return bu -> names;
+}
+
+std::vector<std::shared_ptr<const Layout::Node>> Layout::FrozenBottomUp::findXYLocMap(const LeafNode& leaf,
+		Vector::Axis ax, Scalar width, unsigned n) const
+{
+	std::vector<std::shared_ptr<const Node>> found;
+	std::unordered_map<const Node*, std::vector<Corner>>::const_iterator it { corners.find(&leaf)};
+	if (it == corners.end()) {
+		return found;
+	}
+	// widths match as the keys of the LL maps do: neither is less
+	for (const Corner& corner : it -> second)
+	{
+		const Scalar& w { (ax == Vector::Axis::X) ? corner.xWidth : corner.yWidth};
+		if (!(w < width) && !(width < w) && corner.group -> v -> n == n) {
+			found.push_back(corner.group);
+		}
+	}
+	return found;
+}
+
+Layout::NodeMap Layout::FrozenBottomUp::allSplitGroups(GroupPair ll, LineSegment& line) const
+{
+	Layout::LineOverlapsLine lol{ ll, line};
+	Layout::GroupPair  parent {Layout::findContainingParent(ll, lol)};
+	std::vector<Layout::BranchSplitPair> splits;
+	Layout::branchesWithOverlappingSplit(parent, lol, splits);
+	NodeMap nodes;
+	for (const Layout::BranchSplitPair& pr : splits)
+	{
+		const std::vector<std::vector<std::shared_ptr<const Node>>>& lines { splitGroups.at(pr.first.get())};
+		for (SplitIt split {pr.second.first}; split != pr.second.second; ++split)
+		{
+			for (const std::shared_ptr<const Node>& group : lines[split - pr.first -> splits.begin()])
+			{
+				insertIntoNodeMap(nodes, group);
+			}
+		}
+	}
+	return nodes;
+}
+
+Layout::NodeMap::size_type Layout::FrozenBottomUp::splitCost(GroupPair ll, LineSegment& line) const
+{
+	return allSplitGroups(ll, line).size();
+}
+
 /******************************************************************************************************************
  *    @func     addNodeMaps(NodeMap sum, NodeMap other) will add all the unique
  *    		shared pointers from new into sum.
@@ -759,12 +946,10 @@ void Layout::addToNodeMaps(Layout::NodeMap& sum, const Layout::NodeMap& b)
 //	void addToNodeMaps(NodeMap& sum, const NodeMap& b);
 void Layout::removeNTGroupFromSplitLines( Layout::GroupPair ll, Layout::GroupPair ntGroup)
 {
-	// get the line intersects class to determine overlaps and split lines 
-	Layout::LineIntersects  line( ll, ntGroup);
-	Layout::GroupPair  parent {Layout::findContainingParent(ll, line)};
+	std::shared_ptr<const Node> parent {Layout::coveringNode(ll.first, ntGroup.first -> terms)};
 	std::vector<Layout::BranchSplitPair> splits;
 	// find all the split lines
-	Layout::branchesWithOverlappingSplit(parent, line, splits);
+	Layout::branchesSplittingTerms(parent, ntGroup.first -> terms, splits);
 	for ( Layout::BranchSplitPair pr : splits)
 	{
 		std::shared_ptr<const Layout::BranchNode> br { 
@@ -774,7 +959,7 @@ void Layout::removeNTGroupFromSplitLines( Layout::GroupPair ll, Layout::GroupPai
 			throw std::runtime_error("dynamic cast failed to get branch Node");
 		}
 
-		typedef std::vector<Efloat>::size_type ES;
+		typedef std::vector<Scalar>::size_type ES;
 		ES curr { static_cast<ES>( pr.second.first - br ->splits.begin())};
 		ES last  { static_cast<ES>(pr.second.second - br->splits.begin())};
 		for (; curr < last; ++curr)
@@ -788,24 +973,24 @@ void Layout::removeNTGroupFromSplitLines( Layout::GroupPair ll, Layout::GroupPai
 	}
 }
 // creates a LineSegment from an ntGroup; a line segmenti
-Layout::minMaxPr initializeLSPair ( const EVector& ll, EVector::Axis s, const EVector& size)
+Layout::minMaxPr initializeLSPair ( const Vector& ll, Vector::Axis s, const Vector& size)
 {
-	return  (s == EVector::X) ? Layout::minMaxPr( ll.x, ll.x + size.x):
+	return  (s == Vector::X) ? Layout::minMaxPr( ll.x, ll.x + size.x):
 		                 Layout::minMaxPr(ll.y, ll.y + size.y);
 }
-Efloat  initializeLSCorner ( const EVector& ll, EVector::Axis s)
+Scalar  initializeLSCorner ( const Vector& ll, Vector::Axis s)
 {
-	return  (s == EVector::X) ?  ll.y : ll.x;
+	return  (s == Vector::X) ?  ll.y : ll.x;
 }
-Efloat  initializeLSTransverseVal ( const EVector& ll, EVector::Axis s, const EVector& size)
+Scalar  initializeLSTransverseVal ( const Vector& ll, Vector::Axis s, const Vector& size)
 {
-	return  (s == EVector::X) ?  ll.y +  size.y: ll.x  + size.x;
+	return  (s == Vector::X) ?  ll.y +  size.y: ll.x  + size.x;
 }
-EVector::Axis  oppositeAxis(EVector::Axis ax)
+Vector::Axis  oppositeAxis(Vector::Axis ax)
 {	
-	return (ax == EVector::Axis::X) ? EVector::Axis::Y : EVector::Axis::X;
+	return (ax == Vector::Axis::X) ? Vector::Axis::Y : Vector::Axis::X;
 }
-Layout::LineSegment::LineSegment(const EVector& ll, EVector::Axis s, std::shared_ptr<const Node> ntGroup):
+Layout::LineSegment::LineSegment(const Vector& ll, Vector::Axis s, std::shared_ptr<const Node> ntGroup):
 ax{s}, pr{initializeLSPair(ll, ax, ntGroup->size)}, 
 	transverseVal {initializeLSTransverseVal( ll, ax, ntGroup -> size)} 
 {}
@@ -815,7 +1000,7 @@ Layout::LineSegment::LineSegment(GroupPair gpr,  SplitIt  split) : ax { opposite
 	     transverseVal{ initializeLSCorner(gpr.second, ax) + *split } 
 {}
        
-Layout::LeafNode::LeafNode(const EVector& sz, const EVector::Axis sd, std::vector<Efloat>&& ss,
+Layout::LeafNode::LeafNode(const Vector& sz, const Vector::Axis sd, std::vector<Scalar>&& ss,
 					std::weak_ptr<const Node>  p,
 				std::shared_ptr<NodeValue> v ):
 				Node(sz, sd, std::move(ss), p, v)
@@ -847,7 +1032,7 @@ Layout::InsertType Layout::LeafNode::addGroupToXYLocMap(std::shared_ptr<const No
 	// inserted. Node is not inserted yet!
 	if (NotFound) {
 		 std::pair<XYWidth::iterator, bool> success{
-			 LL.insert(std::pair<Efloat, YWidth>(inNode->size.x, YWidth()))};
+			 LL.insert(std::pair<Scalar, YWidth>(inNode->size.x, YWidth()))};
 		 if (!success.second) {
 			throw std::runtime_error("failed to insert in XYWidth Map");
 		 }
@@ -892,8 +1077,30 @@ Layout::InsertType Layout::LeafNode::addGroupToXYLocMap(std::shared_ptr<const No
 	return type;
 }
 
+Layout::InsertType Layout::LeafNode::probeXYLocMap(const Vector& size, unsigned n) const
+{
+	XYWidth::const_iterator  XYit {LL.find(size.x)};
+	if (XYit == LL.end()) {
+		return InsertType::NewNode;
+	}
+	YWidth::const_iterator Yit { XYit -> second.find(size.y)};
+	if (Yit == XYit -> second.end()) {
+		return InsertType::NewNode;
+	}
+	std::shared_ptr<const Node> foundVal { Yit -> second.lock()};
+	if (foundVal == nullptr) {
+		return InsertType::NewExpired;
+	}
+	if (n != foundVal -> v -> n)
+	{
+		throw std::runtime_error("Two groups with the same size have different"
+				"numbers of primitives");
+	}
+	return InsertType::OldNode;
+}
+
 /****************************************************************************************************
- * @function  list<std::shared_ptr<const Node>>  findXYLocMap(EVector::Axis ax, Efloat
+ * @function  list<std::shared_ptr<const Node>>  findXYLocMap(Vector::Axis ax, Scalar
  * 		size)
  * @params[in]    ax is either X or Y, the axis to look for;
  *                size is the size to match to, 
@@ -902,11 +1109,11 @@ Layout::InsertType Layout::LeafNode::addGroupToXYLocMap(std::shared_ptr<const No
  * @params[out]   list<std::weak_ptr<const Node>>  the list of weak_ptrs to
  * Nodes that match.
  * ****************************************************************************************************/
-std::list<std::shared_ptr<const Layout::Node>>  Layout::LeafNode::findXYLocMap(EVector::Axis ax, 
-					Efloat width, unsigned n) const
+std::list<std::shared_ptr<const Layout::Node>>  Layout::LeafNode::findXYLocMap(Vector::Axis ax, 
+					Scalar width, unsigned n) const
 {
 	std::list<std::shared_ptr<const Node>> list;
-	if (ax == EVector::Axis::X) { 
+	if (ax == Vector::Axis::X) { 
 		XYWidth::iterator  XYit { LL.find(width)};
 		if (XYit == LL.end())
 		{
@@ -945,10 +1152,10 @@ std::list<std::shared_ptr<const Layout::Node>>  Layout::LeafNode::findXYLocMap(E
 	}
 	return list;
 }
-std::list<std::shared_ptr<const Layout::Node>>  Layout::LeafNode::findXYLocMap(EVector::Axis ax, Efloat width) const
+std::list<std::shared_ptr<const Layout::Node>>  Layout::LeafNode::findXYLocMap(Vector::Axis ax, Scalar width) const
 {
 	std::list<std::shared_ptr<const Node>> list;
-	if (ax == EVector::Axis::X) { 
+	if (ax == Vector::Axis::X) { 
 		XYWidth::iterator  XYit { LL.find(width)};
 		if (XYit == LL.end())
 		{
@@ -1005,21 +1212,21 @@ bool Layout::LeafNode::removeFromXYLocMap(std::shared_ptr<const Layout::Node> in
 	return true;
 }
 
-Layout::nGroupPair Layout::makeParentGroup(const std::vector<Layout::GroupPair> PrChildren, EVector::Axis splitDir, 
+Layout::nGroupPair Layout::makeParentGroup(const std::vector<Layout::GroupPair> PrChildren, Vector::Axis splitDir, 
 			    std::string name)
 {
 	
 	if (PrChildren.size() == 0) {
-		return Layout::nGroupPair( nullptr, EVector());
+		return Layout::nGroupPair( nullptr, Vector());
 	}
 	nGroupPair parentGrp { nullptr , PrChildren[0].second};
 	std::vector<std::shared_ptr<const Node>> children;
-	std::vector<Efloat>  splits;
+	std::vector<Scalar>  splits;
 	std::shared_ptr<NodeValue>  v { std::make_shared<NodeValue>(NodeValue{
 				std::numeric_limits<uIDType>::max(), name, 0})};
 	typedef std::vector<Layout::GroupPair>::const_iterator GrpPairIt;
 	GrpPairIt last {PrChildren.cend()};
-	EVector size;
+	Vector size;
 	for (GrpPairIt it {PrChildren.cbegin()};it < last; ++it)
 	{
 		children.push_back(it -> first);
@@ -1027,7 +1234,7 @@ Layout::nGroupPair Layout::makeParentGroup(const std::vector<Layout::GroupPair>
 		// prior to last iteration
 		if ( it + 1 != last) 
 		{
-			if (splitDir == EVector::Axis::X)
+			if (splitDir == Vector::Axis::X)
 			{
 				splits.push_back(it->second.x + it -> first-> size.x -
 						parentGrp.second.x);
@@ -1045,6 +1252,10 @@ Layout::nGroupPair Layout::makeParentGroup(const std::vector<Layout::GroupPair>
 	}
 	parentGrp.first = std::make_shared<Node>(size, splitDir, std::move(splits), 
 			std::weak_ptr<Node>(), v);
+	for (const std::shared_ptr<const Node>& child : children)
+	{
+		parentGrp.first -> terms.unite(child -> terms);
+	}
 	parentGrp.first -> children = std::move(children);
 	return parentGrp;
 }
@@ -1053,73 +1264,12 @@ Layout::nGroupPair Layout::makeParentGroup(const std::vector<Layout::GroupPair>
 	
 
 	
-// returns a list of Children Nodes ordered according to the splits
-// The node passed in is the Top level serializable node
-std::vector<std::shared_ptr<const Layout::Node>> Layout::BottomUp::GetChildren(const std::vector<Efloat>& splits, 
-				const EVector::Axis ax, const tinyxml2::XMLNode * parent, 
-				std::weak_ptr<const Node> p, const EVector& minVal, 
-				int level, Layout::nameMap& namesFound)
+// reads one SerializableShape: checks its level and box against the splits
+// of its parent and creates its Node.  Its children are left to readChildren.
+Layout::BottomUp::PendingNode Layout::BottomUp::readNode(Layout::XMLNodePr&& nodePr, std::weak_ptr<const Node> p,
+		         const Vector&  minVal, int level, const ShapeNames& xmlNames)
 {
-	std::vector<std::shared_ptr<const Node>> children;
-	// will be for Serializable Shape
-	const tinyxml2::XMLNode * SerShape = parent->FirstChildElement("Children");
-	if (SerShape == nullptr) return children;
-	SerShape = SerShape ->FirstChild();
-	// get all the xml nodes and Bounding Boxes
-	std::vector<XMLNodePr> AllXMLNodes;
-	while (SerShape != nullptr)
-	{
-		AllXMLNodes.push_back( XMLNodePr(SerShape, 
-			std::unique_ptr<BoundBox>( 
-				new BoundBox(SerShape->FirstChildElement("BBox")))));
-		SerShape =SerShape ->NextSibling();
-	}
-	bool validLength = (splits.size() == 0 && AllXMLNodes.size() == 0) ||
-		            (splits.size() != 0  && AllXMLNodes.size() == splits.size() + 1);
-	if ( !validLength) 
-	{
-		throw std::runtime_error("Number of Nodes Not valid");
-	}
-	// sort according to split axis
-
-	EVector childMin {minVal};
-	std::vector<Efloat>::size_type indx {0};
-	if ( ax == EVector::Axis::X)
-	{
-		std::sort(AllXMLNodes.begin(), AllXMLNodes.end(), 
-				[] (const XMLNodePr& a, const XMLNodePr& b) -> bool {
-				   return a.second->min().x < b.second->min().x;});
-		for (  XMLNodePr& pr : AllXMLNodes)
-		{ 
-			children.push_back(XMLNode(std::move(pr), p, childMin, level, namesFound));
-			if ( indx < splits.size()) {
-				childMin.x = minVal.x + splits[indx++];
-			}
-		}
-
-	}
-	else 
-	{ 
-		std::sort(AllXMLNodes.begin(), AllXMLNodes.end(), 
-				[] (XMLNodePr& a, 
-					XMLNodePr& b) -> bool {
-				   return a.second->min().y < b.second->min().y;}); 
-		for ( XMLNodePr& pr : AllXMLNodes)
-		{ 
-			children.push_back(XMLNode(std::move(pr), p, childMin, level, namesFound));
-			if ( indx < splits.size()) {
-				childMin.y = minVal.y + splits[indx++];
-			}
-		}
-	}
-	return children;
-}
-std::shared_ptr<const Layout::Node> Layout::BottomUp::XMLNode(Layout::XMLNodePr&& nodePr, std::weak_ptr<const Node> p,
-		         const EVector&  minVal, int level,  Layout::nameMap& namesFound)
-{
-	const tinyxml2::XMLElement* elem = nodePr.first->FirstChildElement("Level");
-	////// params in file but not used:
-	const tinyxml2::XMLNode * fchild = nodePr.first->FirstChild();
+	const tinyxml2::XMLElement* elem = nodePr.first->FirstChildElement(xmlNames.level);
 	int lvl;
 	std::shared_ptr<NodeValue> v = std::make_shared<NodeValue>();
 	tinyxml2::XMLError err = elem ->QueryIntText(&lvl);
@@ -1131,7 +1281,7 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::XMLNode(Layout::XMLNodePr&
 	{
 		throw std::runtime_error("level is not expected");
 	}
-	elem = nodePr.first->FirstChildElement("UId");
+	elem = nodePr.first->FirstChildElement(xmlNames.uid);
 	int u;
 	err = elem ->QueryIntText(&u);
 	v->uid = static_cast<unsigned>(u);
@@ -1139,70 +1289,191 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::XMLNode(Layout::XMLNodePr&
 	{
 		throw std::runtime_error("failed Uid Conversion");
 	}
-	elem = nodePr.first->FirstChildElement("Isolated");
+	elem = nodePr.first->FirstChildElement(xmlNames.isolated);
 	int val;
 	err = elem ->QueryIntText(&val);
-	bool iso = static_cast<bool>(val);
 	if (err != tinyxml2::XML_SUCCESS)
 	{
 		throw std::runtime_error("failed Isolation Conversion");
 	}
-	elem = nodePr.first->FirstChildElement("Label")->
-	             FirstChildElement("LabelName");
+	elem = nodePr.first->FirstChildElement(xmlNames.label)->
+	             FirstChildElement(xmlNames.labelName);
 	v->name = elem ->GetText();
 	// There are two estimates of location.  One is gotten through all the
 	// splits recursively down the tree.  The other is from the boundBox.
 	// This comparison tests if the two are the same.
-	EVector size {nodePr.second->size()};
+	Vector size {nodePr.second->size()};
 	if (!(nodePr.second->min() == minVal)) {
 
 		throw std::runtime_error("Box Location Error");
 	}
-	const tinyxml2::XMLNode* dir = nodePr.first->FirstChildElement("SplitsX");
-	EVector::Axis splitDir = static_cast<EVector::Axis>(dir -> NoChildren());
-	std::vector<Efloat> splits;
-	if (splitDir == EVector::Axis::X)
+	const tinyxml2::XMLNode* dir = nodePr.first->FirstChildElement(xmlNames.splitsX);
+	Vector::Axis splitDir = static_cast<Vector::Axis>(dir -> NoChildren());
+	std::vector<Scalar> splits;
+	if (splitDir == Vector::Axis::X)
 	{
-		dir = nodePr.first ->FirstChildElement("SplitsX");
+		dir = nodePr.first ->FirstChildElement(xmlNames.splitsX);
 		splits = std::move(parseList(dir, minVal.x));
 	}
 	else {
-		dir = nodePr.first ->FirstChildElement("SplitsY");
+		dir = nodePr.first ->FirstChildElement(xmlNames.splitsY);
 		splits = std::move(parseList(dir, minVal.y));
 	}
-	std::shared_ptr<Node> thisNode;
+	PendingNode pending {nodePr.first, nullptr, nullptr, minVal, level, {}};
 	if ( splits.size() == 0) {
 		v -> n = 1; // only one Node contained here
-		// update namesFound and if there is a prior value return it
-		GroupType  group{ addNodeValue(v, namesFound)};
+		pending.leaf = std::make_shared<LeafNode>(std::move(size), splitDir, std::move(splits),
+				    p,  v);
+		pending.node = pending.leaf;
+	}
+	else {
+		// registerNode adds the terminals of the children
+		v -> n = 0;
+		pending.node = std::make_shared<BranchNode>(std::move(size), splitDir, std::move(splits),
+				    p, v);
+	}
+	return pending;
+}
+// reads the children of pending, ordered according to its splits
+void Layout::BottomUp::readChildren(PendingNode& pending, const ShapeNames& xmlNames)
+{
+	const std::vector<Scalar>& splits {pending.node ->splits};
+	// will be for Serializable Shape
+	const tinyxml2::XMLNode * SerShape = pending.xml->FirstChildElement(xmlNames.children);
+	if (SerShape == nullptr) return;
+	SerShape = SerShape ->FirstChild();
+	// get all the xml nodes and Bounding Boxes
+	std::vector<XMLNodePr> AllXMLNodes;
+	while (SerShape != nullptr)
+	{
+		AllXMLNodes.push_back( XMLNodePr(SerShape, 
+			std::unique_ptr<BoundBox>( 
+				new BoundBox(SerShape->FirstChildElement(xmlNames.bbox), xmlNames))));
+		SerShape =SerShape ->NextSibling();
+	}
+	bool validLength = (splits.size() == 0 && AllXMLNodes.size() == 0) ||
+		            (splits.size() != 0  && AllXMLNodes.size() == splits.size() + 1);
+	if ( !validLength) 
+	{
+		throw std::runtime_error("Number of Nodes Not valid");
+	}
+	// sort according to split axis
+	Vector::Axis ax {pending.node ->splitDir};
+	std::sort(AllXMLNodes.begin(), AllXMLNodes.end(), 
+			[ax] (const XMLNodePr& a, const XMLNodePr& b) -> bool {
+			   return a.second->min()[ax] < b.second->min()[ax];});
+	Vector childMin {pending.minVal};
+	std::vector<Scalar>::size_type indx {0};
+	pending.children.reserve(AllXMLNodes.size());
+	for (  XMLNodePr& pr : AllXMLNodes)
+	{ 
+		pending.children.push_back(readNode(std::move(pr), pending.node, childMin, pending.level + 1,
+					xmlNames));
+		if ( indx < splits.size()) {
+			childMin[ax] = pending.minVal[ax] + splits[indx++];
+		}
+	}
+}
+void Layout::BottomUp::readSubtree(PendingNode& pending, const ShapeNames& xmlNames)
+{
+	readChildren(pending, xmlNames);
+	for (PendingNode& child : pending.children)
+	{
+		readSubtree(child, xmlNames);
+	}
+}
+// reads the level below root breadth first until there are a few subtrees
+// per thread, then reads those subtrees on the threads.  The main thread
+// takes subtrees too, and the rest if a thread cannot be started.
+// tinyxml2 terminates a text in place when it is first read, so no two
+// threads may read the same element; the subtrees share none.
+void Layout::BottomUp::readSubtrees(PendingNode& root, const ShapeNames& xmlNames, unsigned threads)
+{
+	if (threads <= 1) {
+		readSubtree(root, xmlNames);
+		return;
+	}
+	std::vector<PendingNode*> frontier {&root};
+	while (!frontier.empty() && frontier.size() < 4 * threads)
+	{
+		std::vector<PendingNode*> below;
+		for (PendingNode* pending : frontier)
+		{
+			readChildren(*pending, xmlNames);
+			for (PendingNode& child : pending ->children)
+			{
+				below.push_back(&child);
+			}
+		}
+		frontier.swap(below);
+	}
+	// the first error in the order of the subtrees, as a serial read
+	// would find it
+	std::vector<std::exception_ptr> errors(frontier.size());
+	std::atomic<std::size_t> next {0};
+	auto work = [&frontier, &errors, &next, &xmlNames]() {
+		for (std::size_t i {next++}; i < frontier.size(); i = next++)
+		{
+			try {
+				readSubtree(*frontier[i], xmlNames);
+			}
+			catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	try {
+		for (unsigned t {1}; t < threads && t < frontier.size(); ++t)
+		{
+			pool.push_back(std::thread(work));
+		}
+	}
+	catch (const std::system_error&) {
+	}
+	work();
+	for (std::thread& thread : pool)
+	{
+		thread.join();
+	}
+	for (const std::exception_ptr& error : errors)
+	{
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+// registers the nodes read in the order a depth first build meets them:
+// names, uids, TermSet indices and groups come out the same for any
+// number of threads.
+std::shared_ptr<const Layout::Node> Layout::BottomUp::registerNode(PendingNode& pending,
+		Layout::nameMap& namesFound)
+{
+	std::shared_ptr<Node> thisNode {pending.node};
+	if (pending.leaf) {
+		// update namesFound and if there is a prior value use it
+		GroupType  group{ addNodeValue(thisNode ->v, namesFound)};
 		// leaf nodes hold the maps of all the groups that have an
 		// origin at the lower left corner
-		std::shared_ptr<LeafNode> lf = std::make_shared<LeafNode>(std::move(size), splitDir, std::move(splits),
-				    p,  v);
-		GroupMap::const_iterator it {addToGroupMap(lf, minVal, group)};
+		pending.leaf -> terms = TermSet(terminalsNumbered++);
+		GroupMap::const_iterator it {addToGroupMap(pending.leaf, pending.minVal, group)};
 		// this adds the node itself as the first group stored in the
 		// Lower Left corner.
-		std::shared_ptr<const LeafNode> clf = std::const_pointer_cast<const LeafNode>(lf);
-		Layout::InsertType val{ lf ->addGroupToXYLocMap(clf)};
+		std::shared_ptr<const LeafNode> clf = std::const_pointer_cast<const LeafNode>(pending.leaf);
+		Layout::InsertType val{ pending.leaf ->addGroupToXYLocMap(clf)};
 		if (val!=InsertType::NewNode) {
 			throw std::runtime_error("This terminal added before or failed to add");
 		}
-		thisNode = lf;
 	}
-	else {
-		v -> n = 0;
-		// add only the terminals in all the children. Get a good count
-		// for the number of terminals contained in the node
-		//GroupType  group{ addNodeValue(v, namesFound)};
-		thisNode = std::make_shared<BranchNode>(std::move(size), splitDir, std::move(splits),
-				    p, v);
-		//GroupMap::iterator it {addToGroupMap(thisNode, minVal, group)}; 
+	thisNode ->children.reserve(pending.children.size());
+	for (PendingNode& child : pending.children)
+	{
+		thisNode ->children.push_back(registerNode(child, namesFound));
 	}
-	thisNode ->children = GetChildren(thisNode ->splits, thisNode->splitDir, nodePr.first, thisNode, 
-							minVal, level + 1, namesFound);
 	for (std::shared_ptr<const Node> child: thisNode ->children)
 	{
 			thisNode -> v-> n += child -> v->n;
+			thisNode -> terms.unite(child -> terms);
 	}
 	return thisNode;
 }
@@ -1210,13 +1481,13 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::XMLNode(Layout::XMLNodePr&
 
 // copyTree should make a copy of otherNode, meaning copy values not sharing th
 // same memory.
-std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<const Layout::Node>   otherNode, const EVector& minVal, 
+std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<const Layout::Node>   otherNode, const Vector& minVal, 
 				std::weak_ptr< const Layout::Node> p)
 {
 	// copy values over
 	std::shared_ptr<NodeValue> v = std::make_shared<NodeValue>(*(otherNode -> v));
 	std::shared_ptr<Node> thisNode;
-	std::vector<Efloat> splits { otherNode->splits};
+	std::vector<Scalar> splits { otherNode->splits};
 	if ( v->terminal()) {
 		// update namesFound and if there is a prior value return it
 		GroupType  group{ addNodeValue(v, names)};
@@ -1227,6 +1498,7 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<
 		}
 		std::shared_ptr<LeafNode> lf = std::make_shared<LeafNode>(otherNode -> size, otherNode ->splitDir, 
 				std::move(splits), p,  v);
+		lf -> terms = TermSet(terminalsNumbered++);
 		GroupMap::const_iterator it {addToGroupMap(lf, minVal, group)};
 		// this adds the node itself as the first group stored in the
 		// Lower Left corner.
@@ -1241,13 +1513,14 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<
 				    p, v);
 		thisNode->v->n = 0; // reset to start counting terminals as a check.
 	}
-	EVector childMin {minVal};
-	std::vector<Efloat>::size_type indx {0};
-	if ( thisNode -> splitDir == EVector::Axis::X) {
+	Vector childMin {minVal};
+	std::vector<Scalar>::size_type indx {0};
+	if ( thisNode -> splitDir == Vector::Axis::X) {
 		for (std::shared_ptr<const Node> child: otherNode ->children)
 		{
 			std::shared_ptr<const Node> x{ copyTree(child, childMin, thisNode) };
 			thisNode->v->n += x->v->n;
+			thisNode->terms.unite(x->terms);
 			thisNode ->children.push_back( x);
 			if (indx < thisNode -> splits.size()){
 				childMin.x = minVal.x + thisNode->splits[indx++];
@@ -1259,6 +1532,7 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<
 		{
 			std::shared_ptr<const Node> x{ copyTree(child, childMin, thisNode) };
 			thisNode->v->n += x->v->n;
+			thisNode->terms.unite(x->terms);
 			thisNode ->children.push_back( x);
 			if (indx < thisNode -> splits.size()){
 				childMin.y = minVal.y + thisNode->splits[indx++];
@@ -1272,8 +1546,8 @@ std::shared_ptr<const Layout::Node> Layout::BottomUp::copyTree( std::shared_ptr<
 }
 
 
-bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node>   thisNode, const EVector& minVal, 
-				const Layout::GroupPair& ntGroup, bool last, bool& termFound) 
+bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node>   thisNode, const Vector& minVal, 
+				const Layout::GroupPair& ntGroup, bool last, bool& termFound, bool overlapOnly) 
 {
 	// copy values over
 	bool valid {false};
@@ -1284,8 +1558,8 @@ bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node
 			return false;
 		}
 		typedef std::list<std::shared_ptr<const Node>> LIST;
-		LIST nodesFoundx{ leaf->findXYLocMap(EVector::Axis::X, ntGroup.first->size.x) };
-		LIST nodesFoundy {leaf->findXYLocMap(EVector::Axis::Y, ntGroup.first->size.y)};
+		LIST nodesFoundx{ leaf->findXYLocMap(Vector::Axis::X, ntGroup.first->size.x) };
+		LIST nodesFoundy {leaf->findXYLocMap(Vector::Axis::Y, ntGroup.first->size.y)};
 		SharedCompare cmp(ntGroup.first);
 		bool shouldFind = !termFound && ntGroup.second == minVal; 
 		LIST::iterator matchFoundx{ std::find_if(nodesFoundx.begin(), nodesFoundx.end(), cmp) };
@@ -1318,12 +1592,13 @@ bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node
 		    return false;
 	    }
 	}
-	EVector childMin {minVal};
-	std::vector<Efloat>::size_type indx {0};
-	if ( thisNode -> splitDir == EVector::Axis::X) {
+	Vector childMin {minVal};
+	std::vector<Scalar>::size_type indx {0};
+	if ( thisNode -> splitDir == Vector::Axis::X) {
 		for (std::shared_ptr<const Node> child: thisNode ->children)
 		{
-			bool valid{checkGroupPairStorage(child, childMin, ntGroup, last, termFound) };
+			bool valid{ (overlapOnly && !child -> terms.intersects(ntGroup.first -> terms)) ||
+				checkGroupPairStorage(child, childMin, ntGroup, last, termFound, overlapOnly) };
 			if (!valid){
 				return false;
 			}
@@ -1335,7 +1610,8 @@ bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node
 	else {
 		for (std::shared_ptr<const Node> child: thisNode ->children)
 		{
-			bool valid{checkGroupPairStorage(child, childMin, ntGroup, last, termFound) };
+			bool valid{ (overlapOnly && !child -> terms.intersects(ntGroup.first -> terms)) ||
+				checkGroupPairStorage(child, childMin, ntGroup, last, termFound, overlapOnly) };
 			if (!valid){
 				return false;
 			}
@@ -1347,11 +1623,21 @@ bool Layout::BottomUp::checkGroupPairStorage( std::shared_ptr<const Layout::Node
 	return true;
 }
 
+bool Layout::BottomUp::checkMutation(const Layout::GroupPair& ntGroup, bool last)
+{
+	bool fullAudit {LAYOUT_AUDIT_PERIOD > 0 && ++mutations % LAYOUT_AUDIT_PERIOD == 0};
+	bool termsFound{ false };
+	bool valid {checkGroupPairStorage(location.first, location.second, ntGroup, last, termsFound, !fullAudit)};
+	return valid && termsFound && testAddingNodes(*this, ntGroup, last);
+}
+
 bool Layout::operator==(const Layout::NodeValue& a, const Layout::NodeValue& b)
 {
 	bool equal {a.uid == b.uid};
 	equal = equal && a.name == b.name;
 	equal = equal && a.n == b.n;
+	equal = equal && a.llGroup == b.llGroup && a.neighbor == b.neighbor;
+	equal = equal && a.joinAxis == b.joinAxis;
 	return equal;
 }
 
@@ -1369,8 +1655,14 @@ bool checkNodeValues(std::shared_ptr<const Layout::NodeValue> a, std::shared_ptr
 
 Layout::GroupType Layout::BottomUp::addNodeValue(std::shared_ptr<NodeValue>& nodeValue, nameMap& nm)
 {
-	nameMap::iterator itName = nm.find( nodeValue->name );
 	GroupType group {GroupType::New};
+	// built groups have no name to look up; addNTGroups only calls this
+	// once it found no matching group.
+	if (nodeValue->built()) {
+		nodeValue->uid = next++;
+		return group;
+	}
+	nameMap::iterator itName = nm.find( nodeValue->name );
 	// not found 
 	if (itName == nm.end())
 	{
@@ -1411,12 +1703,101 @@ Layout::GroupType Layout::BottomUp::addNodeValue(std::shared_ptr<NodeValue>& nod
 }
 
 
+Layout::GroupMap::const_iterator::const_iterator(): map{nullptr}, 
+	slot{std::numeric_limits<uIDType>::max()}, index{0}, stop{std::numeric_limits<uIDType>::max()}
+{}
+Layout::GroupMap::const_iterator::const_iterator(const GroupMap* m, uIDType u, size_type i, uIDType st): map{m}, 
+	slot{u}, index{i}, stop{st}
+{
+	while (slot < stop && slot < map -> slots.size() && index >= map -> slots[slot].size())
+	{
+		++slot;
+		index = 0;
+	}
+	if (slot >= map -> slots.size() && stop == std::numeric_limits<uIDType>::max()) {
+		slot = std::numeric_limits<uIDType>::max();
+		index = 0;
+	}
+}
+Layout::GroupMap::const_iterator::reference Layout::GroupMap::const_iterator::operator*() const
+{
+	return map -> slots[slot][index];
+}
+Layout::GroupMap::const_iterator::pointer Layout::GroupMap::const_iterator::operator->() const
+{
+	return &map -> slots[slot][index];
+}
+Layout::GroupMap::const_iterator& Layout::GroupMap::const_iterator::operator++()
+{
+	*this = const_iterator(map, slot, index + 1, stop);
+	return *this;
+}
+Layout::GroupMap::const_iterator Layout::GroupMap::const_iterator::operator++(int)
+{
+	const_iterator prior {*this};
+	++*this;
+	return prior;
+}
+bool Layout::GroupMap::const_iterator::operator==(const const_iterator& other) const
+{
+	return slot == other.slot && index == other.index;
+}
+bool Layout::GroupMap::const_iterator::operator!=(const const_iterator& other) const
+{
+	return !(*this == other);
+}
+
+std::pair<Layout::GroupMap::const_iterator, Layout::GroupMap::const_iterator> 
+	Layout::GroupMap::equal_range(uIDType u) const
+{
+	if (u >= slots.size() || slots[u].empty()) {
+		return std::make_pair(end(), end());
+	}
+	return std::make_pair(const_iterator(this, u, 0, u + 1), const_iterator(this, u + 1, 0, u + 1));
+}
+Layout::GroupMap::size_type Layout::GroupMap::count(uIDType u) const
+{
+	return (u < slots.size()) ? slots[u].size() : 0;
+}
+Layout::GroupMap::const_iterator Layout::GroupMap::begin() const
+{
+	return const_iterator(this, 0, 0);
+}
+Layout::GroupMap::const_iterator Layout::GroupMap::end() const
+{
+	return const_iterator();
+}
+Layout::GroupMap::const_iterator Layout::GroupMap::insert(const value_type& pr)
+{
+	if (pr.first >= slots.size()) {
+		slots.resize(pr.first + 1);
+	}
+	slots[pr.first].push_back(pr);
+	++total;
+	return const_iterator(this, pr.first, slots[pr.first].size() - 1);
+}
+Layout::GroupMap::const_iterator Layout::GroupMap::erase(const_iterator it)
+{
+	std::vector<value_type>& slot {slots[it.slot]};
+	slot.erase(slot.begin() + static_cast<std::ptrdiff_t>(it.index));
+	--total;
+	return const_iterator(this, it.slot, it.index, it.stop);
+}
+Layout::GroupMap::size_type Layout::GroupMap::size() const
+{
+	return total;
+}
+bool Layout::GroupMap::empty() const
+{
+	return total == 0;
+}
+
 /***************************************************************************************************************
  *              addNodeTo GroupMap; This adds a new Node to the group Map.  It
  *              returns an iterator to the list element that holds the node.
  **************************************************************************************************************/
 Layout::GroupMap::const_iterator Layout::BottomUp::addToGroupMap(
-	std::shared_ptr<const Layout::Node> node, const EVector& minLocation, Layout::GroupType grouptype)
+	std::shared_ptr<const Layout::Node> node, const Vector& minLocation, Layout::GroupType grouptype)
 {
 	uIDType uid =  node -> v-> uid;
 	GroupMapIt itpair  {groups.equal_range(uid)};
@@ -1452,30 +1833,55 @@ Layout::GroupMap::const_iterator Layout::BottomUp::addToGroupMap(
  * constructor
  * **********************************************************************************************************/
 
-Layout::GroupPair Layout::BottomUp::initializeLocationTree(const char * filename)
+Layout::GroupPair Layout::BottomUp::initializeLocationTree(const char * filename,
+		tinyxml2::XMLDocument* scratch, unsigned threads)
 {
-		tinyxml2::XMLDocument doc;
-		doc.LoadFile( filename);
-		tinyxml2::XMLNode *  node = Layout::getMainShape(&doc);
-		Layout::XMLNodePr pr(node,
-			std::unique_ptr<Layout::BoundBox>(
-				new Layout::BoundBox(node->FirstChildElement("BBox"))));
-
+		tinyxml2::XMLDocument local;
+		tinyxml2::XMLDocument& doc { (scratch == nullptr) ? local : *scratch};
+		if (scratch == nullptr) {
+			doc.LoadFileMapped( filename);
+		}
+		else {
+			doc.Reset();
+			doc.LoadFile( filename);
+		}
 		int errorID = doc.ErrorID();
 		if ( errorID != tinyxml2::XML_SUCCESS ) {
 			throw std::runtime_error("Doc did not read correctly");
 		}
+		const ShapeNames xmlNames(doc);
+		tinyxml2::XMLNode *  node = Layout::getMainShape(&doc);
+		Layout::XMLNodePr pr(node,
+			std::unique_ptr<Layout::BoundBox>(
+				new Layout::BoundBox(node->FirstChildElement(xmlNames.bbox), xmlNames)));
 
-		return GroupPair(XMLNode(std::move(pr), 
-					std::weak_ptr<const Node>(), 
-					pr.second->min(), 0, names), pr.second ->min());
+		Vector minVal {pr.second->min()};
+		PendingNode root {readNode(std::move(pr), std::weak_ptr<const Node>(), minVal, 0, xmlNames)};
+		if (threads == 0) {
+			threads = std::thread::hardware_concurrency();
+		}
+		readSubtrees(root, xmlNames, threads);
+		return GroupPair(registerNode(root, names), minVal);
 }
 
 
-Layout::BottomUp::BottomUp( const char * filename): next{0}, names{}, groups{}, 
-	       location{initializeLocationTree(filename)}
+Layout::BottomUp::BottomUp( const char * filename): 
+	BottomUp(filename, std::numeric_limits<unsigned>::max())
+{}
+Layout::BottomUp::BottomUp( const char * filename, unsigned maxTerms): next{0}, names{}, groups{}, 
+	       location{initializeLocationTree(filename, nullptr, 1)}
 {
-		for (unsigned n{ 1 }; n <= location.first ->v->n; ++n)
+		unsigned last { std::min(maxTerms, location.first ->v->n)};
+		for (unsigned n{ 1 }; n <= last; ++n)
+		{
+			addNTGroups(n);
+		};
+}
+Layout::BottomUp::BottomUp( const char * filename, unsigned maxTerms, tinyxml2::XMLDocument& doc,
+		unsigned threads): next{0}, names{}, groups{}, location{initializeLocationTree(filename, &doc, threads)}
+{
+		unsigned last { std::min(maxTerms, location.first ->v->n)};
+		for (unsigned n{ 1 }; n <= last; ++n)
 		{
 			addNTGroups(n);
 		};
@@ -1505,7 +1911,7 @@ Layout::GroupMap::const_iterator Layout::BottomUp::findNode(std::shared_ptr<cons
 	}
 	if (pr.first == pr.second)
 	{
-		pr.first == groups.end();
+		pr.first = groups.end();
 		*last = (t == 1);
 	}
 	else {
@@ -1577,7 +1983,7 @@ bool Layout::BottomUp::NodeSplit(Layout::SplitItPair split, const Layout::GroupP
 		return false;
 	}
 	// start location of splits and maps
-        const std::vector<Efloat>::const_iterator splitSt { br -> splits.begin()};
+        const std::vector<Scalar>::const_iterator splitSt { br -> splits.begin()};
 	const std::vector<WeakMap>::const_iterator  mapsSt { br -> splitGroups.begin()};
 	for (SplitIt curr{split.first}; curr != split.second; ++curr)
 	{
@@ -1624,28 +2030,17 @@ bool Layout::BottomUp::NodeSplit(Layout::SplitItPair split, const Layout::GroupP
 
 
 /*************************************************************************************************************
- * @func  	removeSingles  removes groups that are repeated only once
- * @params 	[start, last),   First(inclusive), Last[exclusive] ID to search from
+ * @func  	addRepeatedToSplitLines adds the groups of one pass that repeat to the split lines
  * ************************************************************************************************************/
-void Layout::BottomUp::removeSingles(uIDType current, uIDType last)
+void Layout::BottomUp::addRepeatedToSplitLines(const std::vector<std::pair<GroupPair, GroupPair>>& built)
 {
-	for (; current < last; ++current)
+	for (const std::pair<GroupPair, GroupPair>& pr : built)
 	{
-		//Exactly one element was found
-		// need the range so only look up once.
-		GroupMapIt pr{ groups.equal_range(current) };
-		//GroupMap::size_type t = static_cast<GroupMap::
-		//	size_type>(std::distance(pr.first, pr.second));
-		if (pr.first == groups.end()) {
-			// no elements found
-			continue;
-		}
-		GroupMap::const_iterator second = pr.first;
-		++second;
-		// one element so delete
-		if (second == pr.second) {
-			removeGroupPair( pr.first, RemoveType::LastSplitOnly);
+		bool single { groups.count(pr.second.first -> v -> uid) == 1};
+		if (!single) {
+			addNTGroupToSplitLines(pr.first, pr.second);
 		}
+		assert(checkMutation(pr.second, single));
 	}
 }
 
@@ -1653,7 +2048,8 @@ Layout::GroupMap::const_iterator Layout::BottomUp::removeGroupPair( Layout::Grou
 {
 	//  they have not been removed
 	bool splitsRemovedPrior { type == RemoveType::LastSplitRemoved};
-	if ( type == RemoveType::LastAll || type == RemoveType::LastSplitRemoved) 
+	if ( !it -> second.first -> v -> built() &&
+			(type == RemoveType::LastAll || type == RemoveType::LastSplitRemoved)) 
 	{
 		nameMap::iterator  nameit = names.find( it -> second.first -> v -> name);
 		if (nameit == names.end())
@@ -1662,13 +2058,9 @@ Layout::GroupMap::const_iterator Layout::BottomUp::removeGroupPair( Layout::Grou
 		}
 		names.erase(nameit);
 	}
-	bool termsFound{ false };
-	assert( checkGroupPairStorage(location.first,
-			location.second, it ->second, splitsRemovedPrior, termsFound) );
-	assert(termsFound);
-	assert(testAddingNodes(*this, it ->second, splitsRemovedPrior));
+	assert(checkMutation(it ->second, splitsRemovedPrior));
 	// remove from all the splitlines
-	EVector StartSearch = it -> second.second;
+	Vector StartSearch = it -> second.second;
 	std::shared_ptr<const LeafNode>  llcorner { findLLNode(it -> second.first , 
 			                                    StartSearch,
 		                            it -> second.second)};
@@ -1697,11 +2089,11 @@ Layout::GroupMap::const_iterator Layout::BottomUp::removeNode(std::shared_ptr<co
 		}
 	       	GroupMap::size_type t {0};
 	        GroupMap::const_iterator lastValid{ pr.second};
-		GroupMap::const_iterator next {pr.first};
 		bool removedSuccess{ false};
 		for (; pr.first != pr.second; ++pr.first)
 		{
 			// the next iterator in the series
+			GroupMap::const_iterator next {pr.first};
 			++next;
 			if (pr.first ->second.first == n)
 			{
@@ -1759,9 +2151,10 @@ void Layout::BottomUp::removeNodes(Layout::NodeMap& nMap)
 	       // n number matched
 	       GroupMap::size_type n {0};
 	       GroupMap::const_iterator lastValid{ pr.second};
-	       GroupMap::const_iterator next {pr.first};
 	       for ( ; pr.first != pr.second; )
 	       {
+		      // erasing shifts the pairs after pr.first, so take next afresh
+		      GroupMap::const_iterator next {pr.first};
 		      next++;
 		      auto lam{
 				   [=](const std::pair<uIDType, std::shared_ptr<const Node>>& T) -> bool
@@ -1816,7 +2209,7 @@ void Layout::BottomUp::removeNodes(Layout::NodeMap& nMap)
 					
 
 // true if   ll <= d (desired) < ll + size, false otherwise
-bool withinBox (const EVector& ll, const EVector& size, const EVector& d)
+bool withinBox (const Vector& ll, const Vector& size, const Vector& d)
 {
 	bool  within { ll.x <= d.x && d.x < ll.x + size.x};
 	within = within && (ll.y <= d.y && d.y < ll.y + size.y);
@@ -1826,7 +2219,7 @@ bool withinBox (const EVector& ll, const EVector& size, const EVector& d)
 // provide a child and an absolute LL coordinate, and this finds the lower left
 // coordinate of the parent.
 void   Layout::parentLLCorner(std::shared_ptr<const  Layout::Node> parent, std::shared_ptr<const Layout::Node> child, 
-				EVector& minValueChild)
+				Vector& minValueChild)
 {
 	std::vector<std::shared_ptr<const Layout::Node>>::const_iterator it = find(parent->children.cbegin(), 
 						parent->children.cend(), child);
@@ -1839,7 +2232,7 @@ void   Layout::parentLLCorner(std::shared_ptr<const  Layout::Node> parent, std::
 	{
 		return;
 	}
-	if (parent -> splitDir == EVector::Axis::X)
+	if (parent -> splitDir == Vector::Axis::X)
 	{
 		minValueChild.x -= parent->splits[diff -1];
 	}
@@ -1852,25 +2245,25 @@ void   Layout::parentLLCorner(std::shared_ptr<const  Layout::Node> parent, std::
 
 /**************************************************************************************************
  * @func    std::shared_ptr<Node> findLLNode(std::shared_ptr<Node> init, Evector& lowerLeft, 
- * 				const EVector& term)
+ * 				const Vector& term)
  * @params[in]    std::shared_ptr<const Node> init: start Node. If it is a terminal node then you
  * 			can navigate the location KD tree and go up and down.
  * 			If it is a groupNode in the KD tree then you also can go
  * 			up and down.  It can also be used to find the Lower Left
  * 			corner of a group node. In this case the lowerleft and
  * 			term should be the same.
- *                EVector& ll init location of that node in the
+ *                Vector& ll init location of that node in the
  *                		spatial structure. This will get updated for each call up and down, so
  *                		will get modified
  *                		 as the algorithm traverses the tree.
- * 		  const EVector&   term the lower left corner that one wants to get to
+ * 		  const Vector&   term the lower left corner that one wants to get to
  * @params[out]   std::shared_ptr< const Node>  the terminal node with this coordinate or null if no
  *                        such pointer exists
  * @precondition  initial node exists.
  * @brief          will look through the tree starting at the GroupPair, searching up the tree
  * 		   or down the tree and return the node that has the lowerLeft corner at term
  ************************************************************************************************/
-std::shared_ptr<const Layout::LeafNode> Layout::findLLNode(std::shared_ptr< const Layout::Node> curr,  EVector& ll, const EVector& term)
+std::shared_ptr<const Layout::LeafNode> Layout::findLLNode(std::shared_ptr< const Layout::Node> curr,  Vector& ll, const Vector& term)
 {
 	if (curr == nullptr) {
 		throw std::runtime_error("initial Node is null\n");
@@ -1898,18 +2291,16 @@ std::shared_ptr<const Layout::LeafNode> Layout::findLLNode(std::shared_ptr< cons
 	}
 	// within a child find the child
 	
-	EVector::Axis ax = curr->splitDir;
-	Efloat minVal { ( ax == EVector::Axis::X)? term.x - ll.x: term.y - ll.y};
+	Vector::Axis ax = curr->splitDir;
+	Scalar minVal { ( ax == Vector::Axis::X)? term.x - ll.x: term.y - ll.y};
 	// find the last value that minVal could be inserted and is greater than relativeMin. 
 	// This is the first slit that is greater than the value  and is the correct
 	// function.
-	std::vector<Efloat>::const_iterator it {std::upper_bound( curr->splits.cbegin(), 
-			 	curr->splits.cend(), minVal)};
-	int indx { static_cast<int>(it - curr->splits.cbegin())};
+	int indx { static_cast<int>(curr->splitIndex.upperBound(curr->splits, minVal))};
 	// update the lower bound of the new box
 	if (indx != 0)
 	{
-		if ( ax == EVector::Axis::X) {
+		if ( ax == Vector::Axis::X) {
 			ll.x += curr->splits[indx - 1];
 		}
 		else {
@@ -1966,49 +2357,49 @@ void Layout::BottomUp::addNTGroups(unsigned in)
 	uIDType init {next};
 	for (uIDType u = 0; u < init; u++)
 	{
+		// copy the occurrences of u; inserting into groups may rehash
+		// and invalidate the equal_range iterators.
 		GroupMapIt pr {groups.equal_range(u)};
-		uIDType start{ next };
-		addNTGroups(pr, EVector::Axis::X, in);
-		removeSingles(start, next);
-		start = next;
-		addNTGroups(pr, EVector::Axis::Y, in);
-		removeSingles(start, next);
+		std::vector<GroupPair> occurrences;
+		for (; pr.first != pr.second; ++pr.first) {
+			occurrences.push_back(pr.first -> second);
+		}
+		addNTGroups(occurrences, Vector::Axis::X, in);
+		addNTGroups(occurrences, Vector::Axis::Y, in);
 	}
 }
 // creates new groups. the pr should be at least all the iterators of a unique id.
 // It will check if the created groups match from the start iterator and if it
 // does will use that uid.
-void Layout::BottomUp::addNTGroups(Layout::GroupMapIt pr, EVector::Axis ax, unsigned nTerms)
+void Layout::BottomUp::addNTGroups(const std::vector<Layout::GroupPair>& occurrences, Vector::Axis ax, unsigned nTerms)
 {
 
 	uIDType first {next};
-	// no groups in range
-	if (pr.first == pr.second)
-	{
-			return;
-	}
-	for ( GroupMap::const_iterator it = pr.first; it != pr.second; ++it)
+	// the groups inserted by this pass; their split lines wait until all
+	// of them are counted
+	std::vector<std::pair<GroupPair, GroupPair>> built;
+	for ( std::vector<GroupPair>::const_iterator gp = occurrences.begin(); gp != occurrences.end(); ++gp)
 	{
-		unsigned termsInGroup { it -> second.first->v -> n};
+		unsigned termsInGroup { gp -> first->v -> n};
 		// no groups to add
 		if (termsInGroup >= nTerms){
 			continue;
 		}
 		unsigned termsSeek {nTerms - termsInGroup};
 		// startLoc  where to begin searching
-		EVector startLoc { it ->second.second};
+		Vector startLoc { gp -> second};
 		// this corner is terminal in ll corner. 
-		std::shared_ptr<const LeafNode> thisCorner { findLLNode(it ->second.first, startLoc, it ->second.second)};
-		//bool matchx =it->second.second.x == Efloat(0, Efloat::Normal);
-		//matchx = matchx && it->second.second.y == Efloat(0.0295818001, Efloat::Normal);
+		std::shared_ptr<const LeafNode> thisCorner { findLLNode(gp -> first, startLoc, gp -> second)};
+		//bool matchx =gp -> second.x == Layout::toScalar(0);
+		//matchx = matchx && gp -> second.y == Layout::toScalar(0.0295818001);
 		// target is the LL corner of neighbor sought.
-		EVector target{ it->second.second };
-		if (ax == EVector::Axis::X)
+		Vector target{ gp -> second };
+		if (ax == Vector::Axis::X)
 		{
-			target.x += it->second.first->size.x;
+			target.x += gp -> first->size.x;
 		}
 		else {
-			target.y += it->second.first->size.y;
+			target.y += gp -> first->size.y;
 		}
 		std::shared_ptr<const LeafNode> neighbor  {findLLNode(thisCorner, startLoc, target)};
 		if (neighbor == nullptr) {
@@ -2017,20 +2408,24 @@ void Layout::BottomUp::addNTGroups(Layout::GroupMapIt pr, EVector::Axis ax, unsi
 		// matchingNeighbors will be a list of all groups that match
 		// width and number of terminals.  for neighbor to the left X
 		// should match Y width.
-		std::list<std::shared_ptr<const Node>> matchingNeighbors { (ax == EVector::Axis::X)?
-			 neighbor -> findXYLocMap(EVector::Axis::Y, it -> second.first -> size.y, termsSeek) :
-			 neighbor -> findXYLocMap(EVector::Axis::X, it -> second.first -> size.x, termsSeek)};
+		std::list<std::shared_ptr<const Node>> matchingNeighbors { (ax == Vector::Axis::X)?
+			 neighbor -> findXYLocMap(Vector::Axis::Y, gp -> first -> size.y, termsSeek) :
+			 neighbor -> findXYLocMap(Vector::Axis::X, gp -> first -> size.x, termsSeek)};
 		for (std::shared_ptr<const Node> mneighbor : matchingNeighbors)
 		{
-			const std::vector<GroupPair> children { it -> second, GroupPair( mneighbor, target)};
-			std::ostringstream ss;
-			ss << "Terms : " << nTerms;
-			ss << "; groups : " << it->second.first->v->uid;
-			ss << " & " << mneighbor->v->uid;
-			ss << ((ax == EVector::Axis::X) ? " X" : " Y");
-			nGroupPair NewGroupPr { makeParentGroup( children, ax, ss.str())};
-			//bool matchsizex = NewGroupPr.first->size.x == Efloat(1.0, Efloat::Normal);
-			//matchsizex = matchsizex && NewGroupPr.first->size.y == Efloat(0.269383729, Efloat::Normal);
+			// probe the corner before building the group.  The size is
+			// computed as makeParentGroup does so the Scalars match.
+			Vector size { target + mneighbor -> size - gp -> second};
+			if (thisCorner -> probeXYLocMap(size, nTerms) == InsertType::OldNode) {
+				continue;
+			}
+			const std::vector<GroupPair> children { *gp, GroupPair( mneighbor, target)};
+			nGroupPair NewGroupPr { makeParentGroup( children, ax, std::string())};
+			NewGroupPr.first->v->llGroup = gp -> first->v->uid;
+			NewGroupPr.first->v->neighbor = mneighbor->v->uid;
+			NewGroupPr.first->v->joinAxis = ax;
+			//bool matchsizex = NewGroupPr.first->size.x == Layout::toScalar(1.0);
+			//matchsizex = matchsizex && NewGroupPr.first->size.y == Layout::toScalar(0.269383729);
 
 			// find first matching Group
 			// current has the id of this group;
@@ -2063,14 +2458,8 @@ void Layout::BottomUp::addNTGroups(Layout::GroupMapIt pr, EVector::Axis ax, unsi
 					}
 					addToGroupMap(NewGroupPr.first,
 						NewGroupPr.second, grouptype);
-					// add group to all split lines
-					addNTGroupToSplitLines(GroupPair(thisCorner, it->second.second),
-						NewGroupPr);
-					bool termsFound{ false };
-					assert( checkGroupPairStorage(location.first,
-							location.second, NewGroupPr, false, termsFound) );
-					assert(termsFound);
-					assert(testAddingNodes(*this, NewGroupPr, false));
+					built.push_back(std::make_pair(GroupPair(thisCorner, gp -> second),
+						GroupPair(NewGroupPr)));
 					break;
 				}
 				case NewExpired:
@@ -2088,6 +2477,227 @@ void Layout::BottomUp::addNTGroups(Layout::GroupMapIt pr, EVector::Axis ax, unsi
 		}
 
 	}
+	addRepeatedToSplitLines(built);
+}
+
+void Layout::BottomUp::addRepeatedGroup(const std::vector<GroupPair>& children, Vector::Axis ax,
+		const std::string& name, std::vector<std::pair<GroupPair, GroupPair>>& built)
+{
+	nGroupPair groupPr { makeParentGroup(children, ax, name)};
+	// the LL terminal of the first child is the corner of the group
+	std::shared_ptr<const Node> node {children.front().first};
+	while (!node -> terminal())
+	{
+		node = node -> children.front();
+	}
+	std::shared_ptr<const LeafNode> corner { std::dynamic_pointer_cast<const LeafNode>(node)};
+	if (corner == nullptr) {
+		throw std::runtime_error("Terminal is not a leaf");
+	}
+	InsertType type {corner -> addGroupToXYLocMap(groupPr.first)};
+	if (type == InsertType::OldNode) {
+		return;
+	}
+	if (type != InsertType::NewNode) {
+		throw std::runtime_error("failed to insert repeated group");
+	}
+	GroupType grouptype { addNodeValue(groupPr.first -> v, names)};
+	addToGroupMap(groupPr.first, groupPr.second, grouptype);
+	built.push_back(std::make_pair(GroupPair(corner, groupPr.second), GroupPair(groupPr)));
+}
+
+void Layout::BottomUp::linearizeTerminals(Vector::Axis ax, std::vector<unsigned>& text,
+		std::vector<GroupPair>& at) const
+{
+	// position across ax, then width across ax, then position along ax
+	typedef std::map<Scalar, GroupPair> Line;
+	std::map<Scalar, std::map<Scalar, Line>> lines;
+	for (const GroupMap::value_type& entry : groups)
+	{
+		const GroupPair& gp {entry.second};
+		if (!gp.first -> terminal()) {
+			continue;
+		}
+		if (ax == Vector::Axis::X) {
+			lines[gp.second.y][gp.first -> size.y].insert(std::make_pair(gp.second.x, gp));
+		}
+		else {
+			lines[gp.second.x][gp.first -> size.x].insert(std::make_pair(gp.second.y, gp));
+		}
+	}
+	// uids are all below next, so every separator is a symbol of its own
+	unsigned separator {next};
+	for (const std::pair<const Scalar, std::map<Scalar, Line>>& across : lines)
+	{
+		for (const std::pair<const Scalar, Line>& line : across.second)
+		{
+			Scalar end;
+			for (Line::const_iterator it {line.second.begin()}; it != line.second.end(); ++it)
+			{
+				if (it != line.second.begin() && !(it -> first == end)) {
+					text.push_back(separator++);
+					at.push_back(GroupPair());
+				}
+				text.push_back(it -> second.first -> v -> uid);
+				at.push_back(it -> second);
+				end = it -> first + ((ax == Vector::Axis::X) ?
+						it -> second.first -> size.x : it -> second.first -> size.y);
+			}
+			text.push_back(separator++);
+			at.push_back(GroupPair());
+		}
+	}
+}
+
+unsigned Layout::BottomUp::addRepeatedRuns(unsigned minRun)
+{
+	GroupMap::size_type before {groups.size()};
+	for (Vector::Axis ax : {Vector::Axis::X, Vector::Axis::Y})
+	{
+		std::vector<unsigned> text;
+		std::vector<GroupPair> at;
+		linearizeTerminals(ax, text, at);
+		for (const RepeatRun& run : maximalRepeats(text, std::max(minRun, 2u)))
+		{
+			std::ostringstream name;
+			name << "Run " << ((ax == Vector::Axis::X) ? "X" : "Y") << " :";
+			for (unsigned i {0}; i < run.length; ++i)
+			{
+				name << " " << text[run.starts.front() + i];
+			}
+			std::vector<std::pair<GroupPair, GroupPair>> built;
+			for (unsigned start : run.starts)
+			{
+				const std::vector<GroupPair> children(at.begin() + start,
+						at.begin() + start + run.length);
+				addRepeatedGroup(children, ax, name.str(), built);
+			}
+			addRepeatedToSplitLines(built);
+		}
+	}
+	return static_cast<unsigned>(groups.size() - before);
+}
+
+void Layout::BottomUp::terminalGrid(std::vector<unsigned>& grid, std::vector<GroupPair>& at,
+		unsigned& rows, unsigned& cols) const
+{
+	// the lines where terminals start or end, numbered left to right and
+	// bottom to top
+	std::map<Scalar, unsigned> xLines, yLines;
+	std::vector<GroupPair> terminals;
+	for (const GroupMap::value_type& entry : groups)
+	{
+		const GroupPair& gp {entry.second};
+		if (!gp.first -> terminal()) {
+			continue;
+		}
+		terminals.push_back(gp);
+		xLines[gp.second.x];
+		xLines[gp.second.x + gp.first -> size.x];
+		yLines[gp.second.y];
+		yLines[gp.second.y + gp.first -> size.y];
+	}
+	unsigned line {0};
+	for (std::pair<const Scalar, unsigned>& x : xLines)
+	{
+		x.second = line++;
+	}
+	line = 0;
+	for (std::pair<const Scalar, unsigned>& y : yLines)
+	{
+		y.second = line++;
+	}
+	cols = xLines.empty() ? 0 : static_cast<unsigned>(xLines.size() - 1);
+	rows = yLines.empty() ? 0 : static_cast<unsigned>(yLines.size() - 1);
+	grid.assign(rows * cols, 0);
+	at.assign(rows * cols, GroupPair());
+	std::vector<bool> filled(rows * cols, false);
+	for (const GroupPair& gp : terminals)
+	{
+		unsigned c { xLines.at(gp.second.x)};
+		unsigned r { yLines.at(gp.second.y)};
+		// a terminal spanning more than one cell leaves its cells holes
+		if (xLines.at(gp.second.x + gp.first -> size.x) == c + 1 &&
+				yLines.at(gp.second.y + gp.first -> size.y) == r + 1) {
+			grid[r * cols + c] = gp.first -> v -> uid;
+			at[r * cols + c] = gp;
+			filled[r * cols + c] = true;
+		}
+	}
+	// uids are all below next, so every hole is a symbol of its own
+	unsigned hole {next};
+	for (std::vector<unsigned>::size_type i {0}; i < grid.size(); ++i)
+	{
+		if (!filled[i]) {
+			grid[i] = hole++;
+		}
+	}
+}
+
+unsigned Layout::BottomUp::addRepeatedTiles()
+{
+	GroupMap::size_type before {groups.size()};
+	std::vector<unsigned> grid;
+	std::vector<GroupPair> at;
+	unsigned rows {0}, cols {0};
+	terminalGrid(grid, at, rows, cols);
+	for (const RepeatTile& tile : repeatedTiles(grid, rows, cols))
+	{
+		std::pair<unsigned, unsigned> first {tile.starts.front()};
+		std::ostringstream name;
+		name << "Tile " << tile.rows << "x" << tile.cols << " :";
+		for (unsigned r {0}; r < tile.rows; ++r)
+		{
+			if (r > 0) {
+				name << " /";
+			}
+			for (unsigned c {0}; c < tile.cols; ++c)
+			{
+				name << " " << grid[(first.first + r) * cols + first.second + c];
+			}
+		}
+		std::vector<std::pair<GroupPair, GroupPair>> built;
+		for (const std::pair<unsigned, unsigned>& start : tile.starts)
+		{
+			std::vector<GroupPair> children;
+			if (tile.rows == 1) {
+				std::vector<GroupPair>::const_iterator row { at.begin() + start.first * cols + start.second};
+				children.assign(row, row + tile.cols);
+				addRepeatedGroup(children, Vector::Axis::X, name.str(), built);
+				continue;
+			}
+			// one child per row.  A row of one cell is its terminal; a
+			// wider row was added as a one row tile before any taller
+			// tile, so it is the group of its width at its corner.
+			for (unsigned r {0}; r < tile.rows; ++r)
+			{
+				const GroupPair& cell {at[(start.first + r) * cols + start.second]};
+				if (tile.cols == 1) {
+					children.push_back(cell);
+					continue;
+				}
+				const GroupPair& last {at[(start.first + r) * cols + start.second + tile.cols - 1]};
+				Scalar width { last.second.x + last.first -> size.x - cell.second.x};
+				std::shared_ptr<const LeafNode> corner { std::dynamic_pointer_cast<const LeafNode>(cell.first)};
+				std::shared_ptr<const Node> strip;
+				for (std::shared_ptr<const Node> candidate :
+						corner -> findXYLocMap(Vector::Axis::Y, cell.first -> size.y, tile.cols))
+				{
+					if (candidate -> size.x == width) {
+						strip = candidate;
+						break;
+					}
+				}
+				if (strip == nullptr) {
+					throw std::runtime_error("Tile row not found in groups");
+				}
+				children.push_back(GroupPair(strip, cell.second));
+			}
+			addRepeatedGroup(children, Vector::Axis::Y, name.str(), built);
+		}
+		addRepeatedToSplitLines(built);
+	}
+	return static_cast<unsigned>(groups.size() - before);
 }
 
 
@@ -2122,11 +2732,11 @@ bool Layout::testAddingNodes(const BottomUp&  bu, GroupPair pr, bool priorlast)
 		 return false;
 	 }
 	// test corner location;
-        EVector startLocation { bu.location.second};
+        Vector startLocation { bu.location.second};
 		std::shared_ptr<const LeafNode> llCorner{ findLLNode(bu.location.first, startLocation, pr.second) };
 	// look for it using the X Width
 	typedef std::list<std::shared_ptr<const Node>> LIST;
-	LIST nodesFound = llCorner->findXYLocMap(EVector::Axis::X, pr.first -> size.x);
+	LIST nodesFound = llCorner->findXYLocMap(Vector::Axis::X, pr.first -> size.x);
 	SharedCompare cmp(pr.first);
 	LIST::iterator matchFound{ std::find_if(nodesFound.begin(), nodesFound.end(), cmp) };
 	if (matchFound == nodesFound.end()) {
@@ -2138,7 +2748,7 @@ bool Layout::testAddingNodes(const BottomUp&  bu, GroupPair pr, bool priorlast)
 	{
 		return false;
 	}
-	nodesFound = llCorner ->findXYLocMap(EVector::Axis::Y, pr.first -> size.y);
+	nodesFound = llCorner ->findXYLocMap(Vector::Axis::Y, pr.first -> size.y);
 	matchFound = std::find_if(nodesFound.begin(), nodesFound.end(), cmp);
 	// should be found
 	if (matchFound == nodesFound.end()) {
@@ -2160,7 +2770,9 @@ bool Layout::testAddingNodes(const BottomUp&  bu, GroupPair pr, bool priorlast)
 	{
 	        std::shared_ptr<const Node> llcorner {findLLCornerBranch(oneSplit.first)};
 		GroupMap::const_iterator it { bu.findNode(llcorner, &last)};
-		last = last && priorlast;
+		// whether ntGroup is in the split lines depends on ntGroup,
+		// not on the terminal at the corner of the branch
+		last = priorlast;
 		 if (it == bu.groups.end()) {
 			 return false;
 		 }
@@ -1,15 +1,29 @@
 #pragma
-#include "efloat.h"
+#include "layoutScalar.h"
+#include "intervalBatch.h"
+#include "termSet.h"
 #include <string>
 #include <vector>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <unordered_map>
 #include <unordered_set>
 #include <map>
 #include <list>
+#include <iterator>
 #include "tinyxml2.h"
 namespace Layout {
+/*****************************************************************************************************
+ * 	ShapeNames are the element names of a SerializableFacade interned in one document,
+ * 	so the tree is read by comparing pointers instead of strings.  A name the
+ * 	document does not use stays empty and finds no element.
+ * ***************************************************************************************************/
+	struct ShapeNames {
+		explicit ShapeNames(const tinyxml2::XMLDocument& doc);
+		tinyxml2::XMLName bbox, min, max, size, x, y, z;
+		tinyxml2::XMLName children, level, uid, isolated, label, labelName, splitsX, splitsY;
+	};
 /*****************************************************************************************************
  * 	BoundBox holds all the data retreived from the XML files 
  *        Holds the bounding box of dimensions that a Node has  minVal is the min, maxVal the max
@@ -18,16 +32,18 @@ namespace Layout {
 	class BoundBox
 	{
 	public:
-		BoundBox(EVector minV, EVector maxV);
+		BoundBox(Vector minV, Vector maxV);
 		BoundBox(const tinyxml2::XMLNode* node);
+		// as above with the names of node's document already looked up
+		BoundBox(const tinyxml2::XMLNode* node, const ShapeNames& xmlNames);
 		BoundBox();
-		const EVector&  min() const;
-		const EVector&  max() const;
-		const EVector& size() const;
+		const Vector&  min() const;
+		const Vector&  max() const;
+		const Vector& size() const;
 	private:
-		EVector minVal;
-		EVector maxVal;
-		EVector sizeV;
+		Vector minVal;
+		Vector maxVal;
+		Vector sizeV;
 	
 	};
 	// holds a square Facade element.
@@ -43,7 +59,17 @@ namespace Layout {
 		uIDType   	 uid;  // unique id of the node
 		std::string 	name;  //name of the node
 		unsigned           n;  // number of terminals in this node Term = 1
+		// groups built by addNTGroups leave name empty and record where
+		// they came from instead: the uid of the lower left group, of
+		// the neighbor joined to it and the axis they are joined along.
+		uIDType       llGroup {std::numeric_limits<uIDType>::max()};
+		uIDType      neighbor {std::numeric_limits<uIDType>::max()};
+		Vector::Axis joinAxis {Vector::Axis::X};
 		bool terminal() const;  // terminal there is only one terminal Node here.
+		bool built() const;     // true if built by addNTGroups
+		// name, or for built groups "Terms : n; groups : llGroup & neighbor X"
+		// formatted on demand.  Only for export and debugging.
+		std::string label() const;
 	};
 	bool operator==(const NodeValue& a, const NodeValue& b);
 	// has the node and its bounding Box
@@ -54,9 +80,9 @@ namespace Layout {
  * 	     trees that are found in the facade.  The nodes are roots to trees that represent
  * 	     a unique Structure. This basic structure does not have the extras needed for the
  * 	     spatial structure but does have everything needed for the map.
- * @params   const EVector& sz   			the 3D size of the Node
- * 	     const EVector::Axis  sd   			The split axis, generally x or y
- * 	     std::vector<Efloat>&& ss  			The splits as Efloats
+ * @params   const Vector& sz   			the 3D size of the Node
+ * 	     const Vector::Axis  sd   			The split axis, generally x or y
+ * 	     std::vector<Scalar>&& ss  			The splits as Scalars
  * 	     std::vector<std::shared_ptr<Node>>&& cn   	The children of this node not provided to constructor
  * 	     std::weak_ptr<Node>  p    			The parent of this node
  * 	     						This parent is created
@@ -72,17 +98,22 @@ namespace Layout {
  * 		through several additions.  This way the shared pointers to NodeValue get reused
  * ******************************************************************************/
 	struct Node {
-		Node(const EVector& sz, const EVector::Axis sd, std::vector<Efloat>&& ss, 
+		Node(const Vector& sz, const Vector::Axis sd, std::vector<Scalar>&& ss, 
 				 std::weak_ptr<const Node> p,
 					std::shared_ptr<NodeValue> v); 
 		std::shared_ptr<NodeValue>  v; // the potentially repeated structure
 						// stores all the information of the node
 		bool terminal() const;  // use v's terminal 
-		const EVector         size; // holds the size of the box
-		const EVector::Axis splitDir; // split along x or y
-		std::vector<Efloat> splits;// the location of the splits
+		const Vector         size; // holds the size of the box
+		const Vector::Axis splitDir; // split along x or y
+		std::vector<Scalar> splits;// the location of the splits
+		// finds the child that holds a coordinate; built from the splits
+		SplitIndex<Scalar> splitIndex;
 		std::vector<std::shared_ptr<const Node>>  children;
 		std::weak_ptr<const Node>  parent;
+		// the terminals of the location tree this node covers.  Set once
+		// the children are; a group covers the terminals of its children.
+		TermSet  terms;
 		virtual ~Node() {}
 	};
 
@@ -99,23 +130,75 @@ namespace Layout {
 	// 		same type, their sizes could be different.  Thus there
 	// 		is one pointer to each unique node.  The second
 	// 		parameter is the Lower Left start location.
-	typedef std::pair<std::shared_ptr<const Node>, const EVector>  GroupPair;
+	typedef std::pair<std::shared_ptr<const Node>, Vector>  GroupPair;
 	// non const Node to pass partially formed nodes
-	typedef std::pair<std::shared_ptr<Node>, const EVector>  nGroupPair;
+	typedef std::pair<std::shared_ptr<Node>, const Vector>  nGroupPair;
 	// List is list of Group Pairs;
 	//childIT  is an iterator over the children of a Node
 	typedef std::vector<std::shared_ptr<const Node>>::const_iterator ChildIt;
 	typedef  std::pair<ChildIt, ChildIt>  ChildItPair; 
 	//splitIT  is an iterator over the splits in a Node
-	typedef std::vector<Efloat>::const_iterator SplitIt;
+	typedef std::vector<Scalar>::const_iterator SplitIt;
 	typedef  std::pair<SplitIt, SplitIt>  SplitItPair; 
 	// List is list of Group Pairs;
 	//typedef std::list<GroupPair>   List;
 	// ListIterator is the iterator to traverse the linked list;
 	//typedef  List::iterator  ListIterator;
-	// GroupMap holds a hashtable of uIDTypes and a Group Pairs
-	// Each groupPair has the same NodeValue but a different Node itself.
-	typedef std::unordered_multimap<uIDType, GroupPair> GroupMap;
+/**************************************************************************************************
+ * GroupMap holds the GroupPairs of every uid.  Each groupPair of a uid has the same NodeValue
+ * 	but a different Node itself.  uids are handed out densely from BottomUp::next,
+ * 	so the pairs of uid u are kept together in an array in slot u instead of in
+ * 	the chains of a hash table.  It has the part of the unordered_multimap
+ * 	interface that BottomUp uses: equal_range(u) is slot u, or (end(), end()) when u
+ * 	has no pairs; its iterators stop at the end of slot u, so pairs inserted
+ * 	later under other uids never join a range already taken.  Iterating from
+ * 	begin() walks the slots in uid order.  insert appends to
+ * 	the slot of its uid.  erase shifts the later pairs of that slot down, so it
+ * 	invalidates the iterators into that slot at and after the erased pair.
+ **************************************************************************************************/
+	class GroupMap {
+	public:
+		typedef std::pair<uIDType, GroupPair> value_type;
+		typedef std::vector<value_type>::size_type size_type;
+		class const_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef GroupMap::value_type value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const value_type* pointer;
+			typedef const value_type& reference;
+			const_iterator();
+			reference operator*() const;
+			pointer operator->() const;
+			const_iterator& operator++();
+			const_iterator operator++(int);
+			bool operator==(const const_iterator& other) const;
+			bool operator!=(const const_iterator& other) const;
+		private:
+			friend class GroupMap;
+			// moves past empty slots, but not past slot stop; past the
+			// last slot an iterator without a stop becomes end()
+			const_iterator(const GroupMap* m, uIDType u, size_type i,
+					uIDType stop = std::numeric_limits<uIDType>::max());
+			const GroupMap* map;
+			uIDType slot;
+			size_type index;
+			uIDType stop;
+		};
+		typedef const_iterator iterator;
+		std::pair<const_iterator, const_iterator> equal_range(uIDType u) const;
+		size_type count(uIDType u) const;
+		const_iterator begin() const;
+		const_iterator end() const;
+		const_iterator insert(const value_type& pr);
+		// returns the pair after the erased one
+		const_iterator erase(const_iterator it);
+		size_type size() const;
+		bool empty() const;
+	private:
+		std::vector<std::vector<value_type>> slots;
+		size_type total {0};
+	};
 	// WeakMap holds a hashtable of uIDTypes and a Group Pairs
 	// Each groupPair has the same NodeValue but a different Node itself.
 	typedef std::pair<GroupMap::const_iterator, GroupMap::const_iterator> GroupMapIt; 
@@ -129,10 +212,10 @@ namespace Layout {
 	// stores Groups indexed by their YWidth.  The YWidth is already grouped
 	// by Xwidth. At one location there should only be one group that has
 	// the same X and Y width.  Hence this is a map, not a multimap
-	typedef std::map<const Efloat, std::weak_ptr<const Node> > YWidth;
-	// first Efloat has Groups ordered by XWidth.  Given a X width, it
+	typedef std::map<const Scalar, std::weak_ptr<const Node> > YWidth;
+	// first Scalar has Groups ordered by XWidth.  Given a X width, it
 	// returns the one mulimap.  That  multimap in stored by ywidth.
-	typedef std::map<const Efloat, YWidth>  XYWidth;
+	typedef std::map<const Scalar, YWidth>  XYWidth;
 	// map of all the groups at a location
 	//	typedef std::unordered_map< , XYWidth>  GroupLoc;
 	// map of all the groups at a location
@@ -158,7 +241,7 @@ namespace Layout {
  * 	       location)
  ******************************************************************************************************/
 	struct BranchNode :Node {
-		        BranchNode(const EVector& sz, const EVector::Axis sd, std::vector<Efloat>&& ss, 
+		        BranchNode(const Vector& sz, const Vector::Axis sd, std::vector<Scalar>&& ss, 
 					std::weak_ptr<const Node> p,
 					std::shared_ptr<NodeValue> v);
 
@@ -173,8 +256,8 @@ namespace Layout {
 			bool removeGroup(std::shared_ptr<const Node> NTGroup, std::vector<int>::size_type ) const;
 	};
 
-	// Pair of Efloats making up a min max along a dimension X or Y
-	typedef   std::pair<Efloat, Efloat> minMaxPr;
+	// Pair of Scalars making up a min max along a dimension X or Y
+	typedef   std::pair<Scalar, Scalar> minMaxPr;
 	// LineSegment encodes a line segment that would be part of a split line. It goes along either X, or Y given 
 	//                  by axis,  with a common transverse coordinate
 	//                  (transverseVal).
@@ -189,7 +272,7 @@ namespace Layout {
 	 * 		    if ax is X then pr.second = ll.x + ntGroup->size.x;
 	 * 		                    transverseVal = ll.y + ntGroup->size.y
 	 **********************************************************************************************/
-		LineSegment(const EVector& ll,  EVector::Axis ax, std::shared_ptr<const Node>  ntGroup);
+		LineSegment(const Vector& ll,  Vector::Axis ax, std::shared_ptr<const Node>  ntGroup);
         /***********************************************************************************************
 	 * LineSegment initializes a GroupPair storing the BranchNode and the LL
 	 * 		       corner.  The line Segment is one of the
@@ -201,9 +284,9 @@ namespace Layout {
 	 *
 	 **********************************************************************************************/
 		LineSegment(GroupPair gpr,  SplitIt  split);
-		const EVector::Axis  ax;  // the direction of min, max, say Y
+		const Vector::Axis  ax;  // the direction of min, max, say Y
 		const minMaxPr  pr; // min and max values of the line say ymin, ymax.
-		const Efloat transverseVal; // the one transverse value say x.
+		const Scalar transverseVal; // the one transverse value say x.
 	};
 
 /******************************************************************************************************************************
@@ -238,7 +321,7 @@ namespace Layout {
  * 			corner.
  * *****************************************************************************************************/
 	struct LeafNode :Node {
-		        LeafNode(const EVector& sz, const EVector::Axis sd, std::vector<Efloat>&& ss,
+		        LeafNode(const Vector& sz, const Vector::Axis sd, std::vector<Scalar>&& ss,
 					std::weak_ptr<const Node> p,
 					std::shared_ptr<NodeValue> v); 
 			// stores all the groups organized by lower left corner
@@ -259,12 +342,21 @@ namespace Layout {
  * 		
  * ****************************************************************************************************/
 		        InsertType addGroupToXYLocMap(std::shared_ptr<const Node> inNode) const;
+/************************************************************************************************************
+ * @func      probeXYLocMap
+ * @args[in]  size  the X and Y width of a group that might be built here
+ *            n     its number of terminals
+ * @return[out]  the InsertType addGroupToXYLocMap would return for a group of
+ * 		this size, without building the group or changing the map.  
+ * 		OldNode means the group need not be built at all.
+ * ****************************************************************************************************/
+		        InsertType probeXYLocMap(const Vector& size, unsigned n) const;
 /******************************************************************************************************
  * bool removeFromXYLocMap will remove a Node from the XY map.  It should be
  * found.  returns true if found and removed successfully */
 		        bool removeFromXYLocMap(std::shared_ptr<const Node> inNode) const;
 /****************************************************************************************************
- * @function  list<std::shared_ptr<const Node>>  findXYLocMap(EVector::Axis ax, Efloat
+ * @function  list<std::shared_ptr<const Node>>  findXYLocMap(Vector::Axis ax, Scalar
  * 		size)
  * @params[in]    ax is either X or Y, the axis to look for;
  *                size is the size to match to, 
@@ -273,37 +365,37 @@ namespace Layout {
  * @params[out]   list<std::weak_ptr<const Node>>  the list of weak_ptrs to
  * Nodes that match.
  * ****************************************************************************************************/
-		std::list<std::shared_ptr<const Node>>  findXYLocMap(EVector::Axis ax, Efloat width, unsigned n) const;
-		std::list<std::shared_ptr<const Node>>  findXYLocMap(EVector::Axis ax, Efloat width) const;
+		std::list<std::shared_ptr<const Node>>  findXYLocMap(Vector::Axis ax, Scalar width, unsigned n) const;
+		std::list<std::shared_ptr<const Node>>  findXYLocMap(Vector::Axis ax, Scalar width) const;
 	};
 
 /**************************************************************************************************
  * @func    std::shared_ptr<Node> findLLNode(std::shared_ptr<Node> init, Evector& lowerLeft, 
- * 				const EVector& term)
+ * 				const Vector& term)
  * @params[in]    std::shared_ptr<const Node> init: start Node. If it is a terminal node then you
  * 			can navigate the location KD tree and go up and down.
  * 			If it is a groupNode in the KD tree then you also can go
  * 			up and down.  It can also be used to find the Lower Left
  * 			corner of a group node. In this case the lowerleft and
  * 			term should be the same.
- *                EVector& ll init location of that node in the
+ *                Vector& ll init location of that node in the
  *                		spatial structure. This will get updated for each call up and down, so
  *                		will get modified
  *                		 as the algorithm traverses the tree.
- * 		  const EVector&   term the lower left corner that one wants to get to
+ * 		  const Vector&   term the lower left corner that one wants to get to
  * @params[out]   std::shared_ptr< const Node>  the terminal node with this coordinate or null if no
  *                        such pointer exists
  * @precondition  initial node exists.
  * @brief          will look through the tree starting at the GroupPair, searching up the tree
  * 		   or down the tree and return the node that has the lowerLeft corner at term
  ************************************************************************************************/
-	std::shared_ptr<const LeafNode> findLLNode(std::shared_ptr<const Node> init, EVector& ll, 
-				const EVector& term);
+	std::shared_ptr<const LeafNode> findLLNode(std::shared_ptr<const Node> init, Vector& ll, 
+				const Vector& term);
 
 // provide a child and an absolute LL coordinate, and this finds the lower left
 // coordinate of the parent.
 	void   parentLLCorner(std::shared_ptr<const  Node> parent, std::shared_ptr<const Node> child, 
-				 EVector& minValueChild);
+				 Vector& minValueChild);
 /******************************************************************************************************************************
  * @func      addNTGroupToSplitLines will insert a non termial group into the
  * 		spatial structure of nodes including a weak reference in all
@@ -346,7 +438,7 @@ namespace Layout {
  * 	   GroupPairs.  The Children altogether should form a rectangle
  * 	   contiguous in one dimension and all the same in the other. 
  * @param[in]  std::vector<GroupPair>  children.  the contiguous children
- *             EVector::Axis           splitdir.  The direction of the splits
+ *             Vector::Axis           splitdir.  The direction of the splits
  *             string                  name       optional name supplied
  * @return    a  GroupPar with all the children together
  * @brief     This creates a ValueNode for the shared group but does not add it
@@ -355,7 +447,7 @@ namespace Layout {
  * 	      terminals.  It does not alter the children in any way and does not
  * 	      reset the children's parents
  * **************************************************************************************************/
-	   nGroupPair makeParentGroup(const std::vector<GroupPair> children, EVector::Axis splitDir, 
+	   nGroupPair makeParentGroup(const std::vector<GroupPair> children, Vector::Axis splitDir, 
 			    std::string name = "unlabeled");   
 /*******************************************************************************************************
  * BottomUp   Holds the data structures for the Bottom up approach.
@@ -365,13 +457,26 @@ namespace Layout {
 		// parse the XML Document
 		// by first opening the file
 		BottomUp( const char *);
+		// parse the XML Document but only build up groups of at most
+		// maxTerms terminals.  maxTerms = 0 leaves only the terminals so
+		// addNTGroups(n) can be driven one level at a time.
+		BottomUp( const char *, unsigned maxTerms);
+		// as above but parses into doc, which the caller keeps for the
+		// next file: doc is Reset() so a batch of loads reuses its node
+		// pools and character buffer.  Nothing refers to doc afterwards.
+		// The location tree is read on up to threads threads; 0 uses
+		// one per core.  The result does not depend on threads.  The
+		// default stays serial: more threads have not been measured faster.
+		BottomUp( const char *, unsigned maxTerms, tinyxml2::XMLDocument& doc, unsigned threads = 1);
 		// this allows one to copy a BottomUp structure.  The copy does
 		// not refer to any nodes in the original so original can be
 		// changed or deleted and copy remains intact.  This allows one
 		// to delete split groups in copy without affecting original.
 		BottomUp( const BottomUp& );
 		// holds the spatial data structure for the location of the NT and terminal regions
-		// cross reference maps names to uids
+		// cross reference maps names to uids.  Only the labels read
+		// from the XML and the runs and tiles of addRepeatedRuns and
+		// addRepeatedTiles; groups built by addNTGroups are not named.
 		uIDType next;
 		nameMap    names;
 		// holds all the grouped nodes that repeat more than once.  One copy per unique ID
@@ -379,6 +484,8 @@ namespace Layout {
 		// pointer to the group and the list of locations, the lower
 		// left coordinate
 		GroupMap groups;
+		// number of terminals given a TermSet index while building location
+		unsigned terminalsNumbered {0};
 		// this holds the locations of the root node together with its
 		// lower left location.
 		GroupPair location;
@@ -456,21 +563,101 @@ namespace Layout {
  * 			found.
  * ************************************************************************************************************/
 		bool NodeSplit(SplitItPair split, const GroupPair& gpr, const GroupPair& ntPr, bool last) const;
+/*************************************************************************************************************
+ * @func      addNTGroups adds Non-terminal Groups to the GroupMap.  It goes
+ * 		through every group in the groupMap and builds nodes that have nTerm terminal regions.  Each pass adds
+ * 		all groups that have a total of nTerms.  
+ * @params[in]  nTerms.  The number of terminals in the built up group. If a
+ * 		group has 3 terminals and nTerms is 5, this would add only
+ * 			groups that have 2 terminals.
+ * 		GroupMapIt pr  These are the GroupPairs to look for neighboring
+ * 			groups.  This is all the groups of type 7.
+ * 		Vector::Axis:: ax  Y means look for groups above and X means
+ * 			look for matching groups to the left.
+ * @precondition:  all lower groups have already been built up.  In
+ * 		example above all repeated groups of 3 and 2 are already in the
+ * 		map.
+ * @brief       Groups are a concatenation of two groups with the same ywidth or
+ * 		xwidth.  In order to build up all the possible 3 element groups,
+ * 		the 2 element groups have to be built; without that you may miss
+ * 		some groups.  For higher N elements, there may be more than one 
+ * 		way to build up the same group, for example it could be a 4 and
+ * 		1 or a 3 and 2. We don't want multiple copies of the same group,
+ * 		so whichever way is built first will get an entry in the LL
+ * 		table of the terminal nodes. There is at most one group with the
+ * 		same LL coordinate and same XWidth and YWidth and the same
+ * 		number of terminals.  If a duplicate is created that will not be
+ * 		added to the groupMap.
+ *****************************************************************************************************************/
+		void addNTGroups(unsigned nTerms);
+/*************************************************************************************************************
+ * @func      addRepeatedRuns adds the runs of terminals that repeat along a row or
+ * 		a column as groups.  The terminals of each row (same Y and Y
+ * 		width) are written out as their uids in X order, a column
+ * 		likewise in Y order, and the maximal repeats of that text are
+ * 		found with a suffix array.  Each occurrence of a repeat becomes
+ * 		one group with all the run's terminals as children, so a bay of
+ * 		twenty windows is found without building every pair, triple and
+ * 		so on first.
+ * @params[in]  minRun  the fewest terminals in a run; at least 2.
+ * @return      the number of groups added.
+ * @brief       An occurrence whose corner already holds a group of the same
+ * 		size and number of terminals is skipped, as in addNTGroups.
+ * 		Runs that end up with one occurrence stay out of the split
+ * 		lines.  Runs are named "Run X : uids" so calling this again adds
+ * 		nothing.
+ *****************************************************************************************************************/
+		unsigned addRepeatedRuns(unsigned minRun);
+/*************************************************************************************************************
+ * @func      addRepeatedTiles adds the rectangular blocks of terminals that repeat
+ * 		as groups.  The terminals are laid on the grid of the lines where
+ * 		they start and end, each cell holding the uid of the terminal
+ * 		that fills it.  repeatedTiles finds every block that occurs more
+ * 		than once by rolling hashes over that grid, so a 2 x 3 bay is
+ * 		found without building its pairs and triples in both axes.
+ * @return      the number of groups added.
+ * @brief       A block of one row is a group of its terminals split along X.
+ * 		A taller block is a group of its rows split along Y, each row
+ * 		the one row group at its corner.  Terminals spanning more than
+ * 		one cell are holes no block crosses.  Blocks are named "Tile
+ * 		RxC : uids" and skipped and kept out of the split lines as in
+ * 		addRepeatedRuns.
+ *****************************************************************************************************************/
+		unsigned addRepeatedTiles();
 	private:
-		//take an XMLNodePr and generate a tree of all subnodes that
-		//have this XMLNodePr as a root.
-		std::shared_ptr<const Node> XMLNode(XMLNodePr&& , std::weak_ptr<const Node> p,
-				const EVector& minVal, int level, nameMap& namesFound);
+		// a node of the location tree read from the XML but not yet in
+		// names or groups.  Reading only touches its own subtree, so
+		// sibling subtrees are read on different threads; registerNode
+		// then adds them all in one depth first pass.
+		struct PendingNode {
+			const tinyxml2::XMLNode* xml;  // the SerializableShape
+			std::shared_ptr<Node> node;
+			std::shared_ptr<LeafNode> leaf; // node if it is a leaf
+			Vector minVal;
+			int level;
+			std::vector<PendingNode> children;
+		};
+		//take an XMLNodePr and make its node; readChildren reads the
+		//children of a node and readSubtree all the nodes below it.
+		static PendingNode readNode(XMLNodePr&& , std::weak_ptr<const Node> p,
+				const Vector& minVal, int level, const ShapeNames& xmlNames);
+		static void readChildren(PendingNode& pending, const ShapeNames& xmlNames);
+		static void readSubtree(PendingNode& pending, const ShapeNames& xmlNames);
+		static void readSubtrees(PendingNode& root, const ShapeNames& xmlNames, unsigned threads);
+		// adds the leaves below pending to namesFound and groups and
+		// links the children; returns pending's node
+		std::shared_ptr<const Node> registerNode(PendingNode& pending, nameMap& namesFound);
 		// initializeLocationTree  parses the XML file, finishes
 		// Location structure and established terminals in the groups
-		// and the names map
-		GroupPair initializeLocationTree(const char * filename);
+		// and the names map.  Loads into scratch if it is not null.
+		GroupPair initializeLocationTree(const char * filename, tinyxml2::XMLDocument* scratch,
+				unsigned threads);
 		// produces a copy of the location with all independent
 		// structures for the new BottomUp Node
 		// recursively add a new Node based on the otherNode but not
 		// using any structures in the otherNode.  It will link to the
 		// parent
-		std::shared_ptr<const Node> copyTree( std::shared_ptr<const Node>   otherNode, const EVector& minVal, 
+		std::shared_ptr<const Node> copyTree( std::shared_ptr<const Node>   otherNode, const Vector& minVal, 
 				std::weak_ptr< const Node> p); 
 /*******************************************************************************************************************
  *  bool checkGroupPairStorage will check if a GroupPair is stored correctly
@@ -480,9 +667,26 @@ namespace Layout {
  *  	           last      means the GroupPair is the last one of its kind. It was
  *  	                     inserted and the splits then removed.  
  *  	           termFound  true if the term was found
+ *  	           overlapOnly  true skips the children that share no terminals
+ *  	           		with ntGroup.  Only those can hold it in their LL map
+ *  	           		or split it, so this checks the same storage
+ *  	           		without walking the whole tree.
  *  	           *************************************************************************************************/
-		bool checkGroupPairStorage( std::shared_ptr<const Node>   otherNode, const EVector& minVal, 
-				const GroupPair& ntGroup, bool last, bool& termFound); 
+		bool checkGroupPairStorage( std::shared_ptr<const Node>   otherNode, const Vector& minVal, 
+				const GroupPair& ntGroup, bool last, bool& termFound, bool overlapOnly = false); 
+/*******************************************************************************************************************
+ *  bool checkMutation is the check run after a GroupPair is inserted or
+ *  		removed.  It checks only the nodes overlapping ntGroup: its LL
+ *  		corner map and the branch splits that cut it.  Every
+ *  		LAYOUT_AUDIT_PERIOD calls it walks the whole tree instead.  0
+ *  		never does the full audit.
+ *  @params[in]   ntGroup   GroupPair that was changed
+ *  	          last      as in checkGroupPairStorage
+ *  @return       true if the storage is valid.  Call it inside assert.
+ *  *****************************************************************************************************************/
+		bool checkMutation(const GroupPair& ntGroup, bool last);
+		// number of checkMutation calls, to schedule the full audits
+		unsigned long mutations {0};
 ///****************************************************************************************************
 // *          addNodeValue will just add the NodeValue to the nameMap; if
 //	    there is one there already, this returns the current one and
@@ -495,24 +699,18 @@ namespace Layout {
  *              addNodeTo GroupMap; This adds a new Node to the group Map.  It
  *              returns an iterator to the list element that holds the node. 
  **************************************************************************************************************/
-		GroupMap::const_iterator addToGroupMap(std::shared_ptr<const Node>, const EVector& minLocation, 
+		GroupMap::const_iterator addToGroupMap(std::shared_ptr<const Node>, const Vector& minLocation, 
 				GroupType expectedNew);
-		// returns a list of Children Nodes ordered according to the splits
-		// The node passed in is the Top level serializable node
-		// args are the splits, the axis (x or y) ,the xmlnode parent
-		// (for the data), the nodeParent, the minVal postion, the level
-		// int and the nameFound. alot of the arguments are to call
-		// xmlnode on the children
-		std::vector<std::shared_ptr<const Node>> GetChildren(const std::vector<Efloat>& splits, 
-				const EVector::Axis ax, const tinyxml2::XMLNode * parent, 
-				std::weak_ptr<const Node> nodeParent, const EVector& minVal, 
-				int level, nameMap& namesFound);
 /*************************************************************************************************************
- * @func  	removeSingles  removes groups from the SplitCost function that
- * 			are singles
- * @params 	[start, last),   First(inclusive), Last[exclusive] ID to search from
+ * @func  	addRepeatedToSplitLines adds the groups built in one addNTGroups pass
+ * 			to the split lines once the pass has counted them.  Groups
+ * 			whose uid occurs only once stay in groups and the LL maps,
+ * 			so larger groups can be built from them, but are never
+ * 			added to the split lines.
+ * @params 	built   the LL corner terminal and the GroupPair of each group
+ * 			the pass inserted
  * ************************************************************************************************************/
-		void removeSingles(uIDType start, uIDType last);
+		void addRepeatedToSplitLines(const std::vector<std::pair<GroupPair, GroupPair>>& built);
 /****************************************************************************************************************
  *  @func       findGroupPair  will find a GroupPair corresponding to a node
  *  @params[in]  std::shared_ptr<const Node> n  the input node to search for.
@@ -522,34 +720,28 @@ namespace Layout {
  *  *************************************************************************************************************/
 		GroupMap::const_iterator findGroupPair(std::shared_ptr<const Node> n);
 
-/*************************************************************************************************************
- * @func      addNTGroups adds Non-terminal Groups to the GroupMap.  It goes
- * 		through every group in the groupMap and builds nodes that have nTerm terminal regions.  Each pass adds
- * 		all groups that have a total of nTerms.  
- * @params[in]  nTerms.  The number of terminals in the built up group. If a
- * 		group has 3 terminals and nTerms is 5, this would add only
- * 			groups that have 2 terminals.
- * 		GroupMapIt pr  These are the GroupPairs to look for neighboring
- * 			groups.  This is all the groups of type 7.
- * 		EVector::Axis:: ax  Y means look for groups above and X means
- * 			look for matching groups to the left.
- * @precondition:  all lower groups have already been built up.  In
- * 		example above all repeated groups of 3 and 2 are already in the
- * 		map.
- * @brief       Groups are a concatenation of two groups with the same ywidth or
- * 		xwidth.  In order to build up all the possible 3 element groups,
- * 		the 2 element groups have to be built; without that you may miss
- * 		some groups.  For higher N elements, there may be more than one 
- * 		way to build up the same group, for example it could be a 4 and
- * 		1 or a 3 and 2. We don't want multiple copies of the same group,
- * 		so whichever way is built first will get an entry in the LL
- * 		table of the terminal nodes. There is at most one group with the
- * 		same LL coordinate and same XWidth and YWidth and the same
- * 		number of terminals.  If a duplicate is created that will not be
- * 		added to the groupMap.
- *****************************************************************************************************************/
-		void addNTGroups(unsigned nTerms);
-		void addNTGroups(GroupMapIt pr, EVector::Axis ax, unsigned nTerms);  
+		// one pass of addNTGroups(nTerms) along ax.  occurrences are all the
+		// GroupPairs of one uid, copied out of groups because inserting
+		// into groups invalidates its iterators.
+		void addNTGroups(const std::vector<GroupPair>& occurrences, Vector::Axis ax, unsigned nTerms);
+		// writes the terminals of every row (ax X) or column (ax Y) into
+		// text as uids, ordered along ax.  A symbol above every uid that
+		// occurs only once ends each contiguous stretch.  at holds the
+		// GroupPair of each symbol, empty for the separators.
+		void linearizeTerminals(Vector::Axis ax, std::vector<unsigned>& text,
+				std::vector<GroupPair>& at) const;
+		// lays the terminals on a rows x cols grid, row major from the
+		// bottom left.  grid holds the uid of the terminal filling each
+		// cell and a symbol above every uid that occurs only once for a
+		// cell no one terminal fills.  at holds the GroupPair of each cell.
+		void terminalGrid(std::vector<unsigned>& grid, std::vector<GroupPair>& at,
+				unsigned& rows, unsigned& cols) const;
+		// makes the group of children split along ax and adds it at the
+		// corner of its LL terminal unless a group of the same size and
+		// terminals is there already.  Named groups with the same name
+		// share a uid.  Adds the corner and group to built.
+		void addRepeatedGroup(const std::vector<GroupPair>& children, Vector::Axis ax,
+				const std::string& name, std::vector<std::pair<GroupPair, GroupPair>>& built);
 	};
 
 /*****************************************************************************************************************
@@ -564,6 +756,51 @@ namespace Layout {
  *           last is true if the GroupPair is the last and already had its splits removed.
  * ***************************************************************************************************************/
 	bool testAddingNodes(const BottomUp&  bu, GroupPair pr, bool last);
+/*****************************************************************************************************************
+ *  @class   FrozenBottomUp is a read only view of a finished BottomUp that any number of
+ *  	     threads can query at once without locks.  LeafNode::LL and
+ *  	     BranchNode::splitGroups are mutable, changed through const members
+ *  	     and hold weak_ptrs, so a BottomUp shared between threads is only safe
+ *  	     while nothing writes and every lookup locks each group it returns.
+ *  	     The view owns its BottomUp so no one can change it, and copies every
+ *  	     corner map and split line once into vectors of shared_ptrs.  Its
+ *  	     queries read those vectors and the location tree; allSplitGroups
+ *  	     still locks the parent weak_ptrs it walks up, which is thread safe
+ *  	     but not free.
+ *  @note    Nodes returned by the view must not be passed to the const members
+ *  	     of LeafNode and BranchNode that change their maps.
+ * ***************************************************************************************************************/
+	class FrozenBottomUp {
+	public:
+		// takes bu over; it cannot be changed afterwards.  There is no
+		// overload that freezes a copy: the BottomUp copy constructor
+		// rebuilds the groups with addNTGroups and loses the rest.
+		explicit FrozenBottomUp(std::unique_ptr<BottomUp> bu);
+		const GroupPair& location() const;
+		const GroupMap& groups() const;
+		const nameMap& names() const;
+		// as leaf.findXYLocMap(ax, width, n)
+		std::vector<std::shared_ptr<const Node>> findXYLocMap(const LeafNode& leaf, Vector::Axis ax,
+				Scalar width, unsigned n) const;
+		// as Layout::allSplitGroups
+		NodeMap allSplitGroups(GroupPair ll, LineSegment& line) const;
+		// the number of groups a split along line would cut
+		NodeMap::size_type splitCost(GroupPair ll, LineSegment& line) const;
+	private:
+		// one entry of an LL corner map
+		struct Corner {
+			Scalar xWidth;
+			Scalar yWidth;
+			std::shared_ptr<const Node> group;
+		};
+		std::unique_ptr<const BottomUp> bu;
+		// the LL map of each leaf in map order, X width then Y width
+		std::unordered_map<const Node*, std::vector<Corner>> corners;
+		// the groups of each split line of each branch
+		std::unordered_map<const Node*, std::vector<std::vector<std::shared_ptr<const Node>>>> splitGroups;
+		// copies the maps of node and its descendents
+		void freeze(const std::shared_ptr<const Node>& node);
+	};
 	tinyxml2::XMLElement* getElement(tinyxml2::XMLDocument*, char* input);
 	
 	tinyxml2::XMLNode* getMainShape(tinyxml2::XMLDocument* doc);
@@ -0,0 +1,129 @@
+# Python program to report how BottomUp scales with the number of terminals.
+#
+# For each grid size it writes a synthetic facade with facadegen, builds its
+# BottomUp with layoutbench --build-only and records the build time and the
+# peak resident memory of that process.  The results are written to
+# <out>.csv and plotted against terminal count in <out>.svg (log-log).
+#
+#   python3 scaling_report.py --bin-dir _gate_build --sizes 8x8,16x16,32x32
+##############################################
+
+import csv
+import math
+import optparse
+import os
+import signal
+import subprocess
+import sys
+import threading
+
+def runMeasured( args, timeout ):
+	# runs args and returns (stdout, peak resident memory in MB), or None if
+	# it did not finish within timeout seconds.  The child is reaped with
+	# wait4 rather than communicate() so its own rusage can be read.
+	proc = subprocess.Popen( args, stdout=subprocess.PIPE, stderr=subprocess.PIPE )
+	timer = threading.Timer( timeout, proc.kill )
+	timer.start()
+	out = proc.stdout.read()
+	err = proc.stderr.read()
+	pid, status, usage = os.wait4( proc.pid, 0 )
+	timer.cancel()
+	proc.returncode = 0 if os.WIFEXITED( status ) else -1
+	if os.WIFSIGNALED( status ) and os.WTERMSIG( status ) == signal.SIGKILL:
+		return None
+	if not os.WIFEXITED( status ) or os.WEXITSTATUS( status ) != 0:
+		sys.stderr.write( err.decode() )
+		raise RuntimeError( "failed: " + " ".join( args ) )
+	# ru_maxrss is in kilobytes on Linux
+	return out.decode(), usage.ru_maxrss / 1024.0
+
+def buildTime( output ):
+	# ms of location tree + addNTGroups total from the layoutbench output
+	total = 0.0
+	groups = 0
+	for line in output.splitlines():
+		fields = line.split()
+		if line.startswith( "location tree" ):
+			total += float( fields[4] )
+		elif line.startswith( "addNTGroups total" ):
+			total += float( fields[4] )
+			groups = int( fields[3] )
+	return total, groups
+
+def svgPlot( rows, filename ):
+	# two log-log panels: build time and peak memory against terminals
+	width, height, pad = 480, 320, 60
+	panels = [ ( "BottomUp build time (ms)", [ r[ "ms" ] for r in rows ], 0 ),
+		   ( "peak memory (MB)", [ r[ "mb" ] for r in rows ], width ) ]
+	terms = [ r[ "terminals" ] for r in rows ]
+	out = [ '<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+		'font-family="sans-serif" font-size="11">' % ( 2 * width, height ) ]
+	lx0, lx1 = math.log10( min( terms ) ), math.log10( max( terms ) )
+	if lx1 == lx0:
+		lx1 = lx0 + 1
+	for title, values, xoff in panels:
+		ly0, ly1 = math.log10( min( values ) ), math.log10( max( values ) )
+		if ly1 == ly0:
+			ly1 = ly0 + 1
+		def px( t ):
+			return xoff + pad + ( math.log10( t ) - lx0 ) / ( lx1 - lx0 ) * ( width - 2 * pad )
+		def py( v ):
+			return height - pad - ( math.log10( v ) - ly0 ) / ( ly1 - ly0 ) * ( height - 2 * pad )
+		out.append( '<text x="%d" y="20">%s</text>' % ( xoff + pad, title ) )
+		out.append( '<line x1="%d" y1="%d" x2="%d" y2="%d" stroke="black"/>' %
+			( xoff + pad, height - pad, xoff + width - pad, height - pad ) )
+		out.append( '<line x1="%d" y1="%d" x2="%d" y2="%d" stroke="black"/>' %
+			( xoff + pad, pad, xoff + pad, height - pad ) )
+		out.append( '<text x="%d" y="%d">terminals</text>' % ( xoff + width / 2 - 20, height - 15 ) )
+		points = " ".join( "%.1f,%.1f" % ( px( t ), py( v ) ) for t, v in zip( terms, values ) )
+		out.append( '<polyline points="%s" fill="none" stroke="steelblue" stroke-width="2"/>' % points )
+		for t, v in zip( terms, values ):
+			out.append( '<circle cx="%.1f" cy="%.1f" r="3" fill="steelblue"/>' % ( px( t ), py( v ) ) )
+			out.append( '<text x="%.1f" y="%.1f">%d: %.3g</text>' % ( px( t ) + 4, py( v ) - 4, t, v ) )
+	out.append( '</svg>' )
+	with open( filename, "w" ) as f:
+		f.write( "\n".join( out ) + "\n" )
+
+def main():
+	parser = optparse.OptionParser( "usage: %prog [options]" )
+	parser.add_option( "--bin-dir", default=".", help="directory holding facadegen and layoutbench" )
+	parser.add_option( "--sizes", default="4x4,8x8,12x12,16x16,24x24", help="comma separated RxC grids" )
+	parser.add_option( "--tile", default="2x3", help="repeating tile RxC" )
+	parser.add_option( "--repeat", default="1.0", help="repetition rate [0, 1]" )
+	parser.add_option( "--depth", default="0", help="nesting depth" )
+	parser.add_option( "--timeout", type="float", default=600.0, help="seconds per size" )
+	parser.add_option( "--out", default="bottomup_scaling", help="prefix of the .csv and .svg" )
+	( options, args ) = parser.parse_args()
+
+	facadegen = os.path.join( options.bin_dir, "facadegen" )
+	layoutbench = os.path.join( options.bin_dir, "layoutbench" )
+	rows = []
+	for size in options.sizes.split( "," ):
+		r, c = size.split( "x" )
+		xml = "%s_%s.xml" % ( options.out, size )
+		subprocess.check_call( [ facadegen, "--rows", r, "--cols", c, "--tile", options.tile,
+					 "--repeat", options.repeat, "--depth", options.depth, "-o", xml ] )
+		bench = [ layoutbench, "--build-only", xml ]
+		result = runMeasured( bench, options.timeout )
+		if result is None:
+			print( "%s: timed out after %g s, stopping" % ( size, options.timeout ) )
+			break
+		ms, groups = buildTime( result[ 0 ] )
+		mb = result[ 1 ]
+		os.remove( xml )
+		row = { "size": size, "terminals": int( r ) * int( c ), "groups": groups, "ms": ms, "mb": mb }
+		rows.append( row )
+		print( "%-8s terminals %7d  groups %9d  %12.1f ms  %9.1f MB" %
+		       ( size, row[ "terminals" ], groups, ms, mb ) )
+
+	if not rows:
+		return
+	with open( options.out + ".csv", "w", newline="" ) as f:
+		writer = csv.DictWriter( f, fieldnames=[ "size", "terminals", "groups", "ms", "mb" ] )
+		writer.writeheader()
+		writer.writerows( rows )
+	if len( rows ) > 1:
+		svgPlot( rows, options.out + ".svg" )
+	print( "wrote " + options.out + ".csv" + ( " and " + options.out + ".svg" if len( rows ) > 1 else "" ) )
+
+main()
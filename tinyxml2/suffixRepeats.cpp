@@ -0,0 +1,121 @@
+#include "suffixRepeats.h"
+#include <algorithm>
+#include <utility>
+
+std::vector<unsigned> Layout::suffixArray(const std::vector<unsigned>& text)
+{
+	unsigned n { static_cast<unsigned>(text.size())};
+	std::vector<unsigned> sa(n), rank(text.begin(), text.end()), next(n);
+	for (unsigned i {0}; i < n; ++i)
+	{
+		sa[i] = i;
+	}
+	// rank of the suffix at i + k, or below every rank past the end
+	for (unsigned k {1}; ; k *= 2)
+	{
+		auto key {[&rank, n, k](unsigned i) -> std::pair<unsigned, long long>
+			{
+				return std::make_pair(rank[i], (i + k < n) ? static_cast<long long>(rank[i + k]) : -1);
+			}};
+		std::sort(sa.begin(), sa.end(), [&key](unsigned a, unsigned b) { return key(a) < key(b);});
+		next[sa[0]] = 0;
+		for (unsigned i {1}; i < n; ++i)
+		{
+			next[sa[i]] = next[sa[i - 1]] + ((key(sa[i - 1]) < key(sa[i])) ? 1 : 0);
+		}
+		rank.swap(next);
+		if (n == 0 || rank[sa[n - 1]] == n - 1 || k >= n) {
+			break;
+		}
+	}
+	return sa;
+}
+
+std::vector<unsigned> Layout::lcpArray(const std::vector<unsigned>& text, const std::vector<unsigned>& sa)
+{
+	unsigned n { static_cast<unsigned>(text.size())};
+	std::vector<unsigned> rank(n), lcp(n, 0);
+	for (unsigned i {0}; i < n; ++i)
+	{
+		rank[sa[i]] = i;
+	}
+	unsigned h {0};
+	for (unsigned i {0}; i < n; ++i)
+	{
+		if (rank[i] == 0) {
+			h = 0;
+			continue;
+		}
+		unsigned j { sa[rank[i] - 1]};
+		while (i + h < n && j + h < n && text[i + h] == text[j + h])
+		{
+			++h;
+		}
+		lcp[rank[i]] = h;
+		if (h > 0) {
+			--h;
+		}
+	}
+	return lcp;
+}
+
+// an lcp interval [lb, rb] of the suffix array: all its suffixes share length symbols
+struct Interval {
+	unsigned length;
+	unsigned lb;
+};
+
+// true if the occurrences in sa[lb, rb] do not all follow the same symbol.  An
+// occurrence at the start of the text counts as following a symbol of its own.
+static bool leftMaximal(const std::vector<unsigned>& text, const std::vector<unsigned>& sa,
+		unsigned lb, unsigned rb)
+{
+	if (sa[lb] == 0) {
+		return true;
+	}
+	unsigned before { text[sa[lb] - 1]};
+	for (unsigned i {lb + 1}; i <= rb; ++i)
+	{
+		if (sa[i] == 0 || text[sa[i] - 1] != before) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<Layout::RepeatRun> Layout::maximalRepeats(const std::vector<unsigned>& text, unsigned minLength)
+{
+	std::vector<RepeatRun> repeats;
+	unsigned n { static_cast<unsigned>(text.size())};
+	if (n < 2) {
+		return repeats;
+	}
+	minLength = std::max(minLength, 1u);
+	std::vector<unsigned> sa { suffixArray(text)};
+	std::vector<unsigned> lcp { lcpArray(text, sa)};
+	// bottom up traversal of the lcp intervals; every interval is right
+	// maximal, so it is a maximal repeat when it is also left maximal.
+	std::vector<Interval> stack {Interval{0, 0}};
+	for (unsigned i {1}; i <= n; ++i)
+	{
+		unsigned l { (i < n) ? lcp[i] : 0};
+		unsigned lb { i - 1};
+		while (l < stack.back().length)
+		{
+			Interval top { stack.back()};
+			stack.pop_back();
+			lb = top.lb;
+			if (top.length >= minLength && leftMaximal(text, sa, top.lb, i - 1)) {
+				RepeatRun r {top.length, std::vector<unsigned>(sa.begin() + top.lb, sa.begin() + i)};
+				std::sort(r.starts.begin(), r.starts.end());
+				repeats.push_back(std::move(r));
+			}
+		}
+		if (l > stack.back().length) {
+			stack.push_back(Interval{l, lb});
+		}
+	}
+	std::stable_sort(repeats.begin(), repeats.end(),
+			[](const RepeatRun& a, const RepeatRun& b) { return a.length > b.length;});
+	return repeats;
+}
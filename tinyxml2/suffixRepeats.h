@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+namespace Layout {
+/*****************************************************************************************************
+ * @struct   RepeatRun
+ * @brief    one maximal repeat of a text: a run of length symbols that occurs at
+ * 	     every position in starts.  It cannot be extended to the right or to the
+ * 	     left at all its occurrences at once.
+ * ***************************************************************************************************/
+	struct RepeatRun {
+		unsigned length;
+		std::vector<unsigned> starts;  // ascending
+	};
+/*****************************************************************************************************
+ * @func     suffixArray returns the start positions of the suffixes of text in
+ * 		sorted order.  Prefix doubling, n log^2 n.
+ * ***************************************************************************************************/
+	std::vector<unsigned> suffixArray(const std::vector<unsigned>& text);
+/*****************************************************************************************************
+ * @func     lcpArray returns lcp[i], the length of the longest common prefix of the
+ * 		suffixes sa[i - 1] and sa[i]; lcp[0] is 0.  Kasai's algorithm, linear.
+ * ***************************************************************************************************/
+	std::vector<unsigned> lcpArray(const std::vector<unsigned>& text, const std::vector<unsigned>& sa);
+/*****************************************************************************************************
+ * @func     maximalRepeats finds every maximal repeat of at least minLength symbols
+ * 		in one pass over the lcp intervals of the suffix array.
+ * @params[in]  text       the symbols.  Symbols that occur once, such as a distinct
+ * 			   separator after each row, keep repeats from spanning rows.
+ * 		minLength  shortest repeat reported; at least 1
+ * @return      the repeats, longest first.  Occurrences of one repeat may overlap.
+ * ***************************************************************************************************/
+	std::vector<RepeatRun> maximalRepeats(const std::vector<unsigned>& text, unsigned minLength);
+}
@@ -0,0 +1,199 @@
+#include "syntheticFacade.h"
+#include "tinyxml2.h"
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	enum Axis { X, Y };
+	/*********************************************************************************************
+	 * FacadeWriter holds the grid and writes it out one SerializableShape at a time.
+	 * 	xs[c] is the left edge of column c, xs[cols] the right edge of the
+	 * 	facade; ys likewise for rows.  All sizes are multiples of 0.25 so the
+	 * 	sums are exact floats and BoundBox's size check always holds.
+	 *********************************************************************************************/
+	class FacadeWriter {
+		public:
+			FacadeWriter(const Layout::SyntheticFacade& p, FILE* fp);
+			void write();
+		private:
+			const Layout::SyntheticFacade& params;
+			tinyxml2::XMLPrinter printer;
+			std::vector<float> xs, ys;
+			std::vector<std::string> labels; // row major rows x cols
+			int uid {0};
+			void writeShape(const char* element, unsigned r0, unsigned r1, unsigned c0, unsigned c1,
+					Axis ax, unsigned nest, int level);
+			void writeVector(const char* element, float x, float y, float z);
+			void writeSplits(const char* element, const std::vector<float>& splits);
+	};
+
+	FacadeWriter::FacadeWriter(const Layout::SyntheticFacade& p, FILE* fp): params{p}, printer{fp}
+	{
+		if (params.rows == 0 || params.cols == 0 || params.tileRows == 0 || params.tileCols == 0) {
+			throw std::runtime_error("synthetic facade needs at least one row, column and tile");
+		}
+		xs.push_back(0.f);
+		for (unsigned c {0}; c < params.cols; ++c)
+		{
+			xs.push_back(xs.back() + 0.5f + 0.25f * static_cast<float>((c % params.tileCols) % 4));
+		}
+		ys.push_back(0.f);
+		for (unsigned r {0}; r < params.rows; ++r)
+		{
+			ys.push_back(ys.back() + 1.0f + 0.25f * static_cast<float>((r % params.tileRows) % 3));
+		}
+		std::mt19937 gen(params.seed);
+		std::uniform_real_distribution<float> dist(0.f, 1.f);
+		for (unsigned r {0}; r < params.rows; ++r)
+		{
+			for (unsigned c {0}; c < params.cols; ++c)
+			{
+				if (dist(gen) < params.repeatRate) {
+					unsigned t { (r % params.tileRows) * params.tileCols + c % params.tileCols};
+					labels.push_back("tile" + std::to_string(t));
+				}
+				else {
+					labels.push_back("cell" + std::to_string(r) + "_" + std::to_string(c));
+				}
+			}
+		}
+	}
+	void FacadeWriter::write()
+	{
+		printer.PushHeader(false, true);
+		printer.OpenElement("SerializableFacade");
+		writeShape("MainShape", 0, params.rows, 0, params.cols, Y, params.depth, 0);
+		printer.OpenElement("FacadeFilename");
+		printer.PushText("synthetic.jpg");
+		printer.CloseElement();
+		printer.CloseElement();
+	}
+	void FacadeWriter::writeVector(const char* element, float x, float y, float z)
+	{
+		printer.OpenElement(element);
+		printer.OpenElement("X");
+		printer.PushText(x);
+		printer.CloseElement(true);
+		printer.OpenElement("Y");
+		printer.PushText(y);
+		printer.CloseElement(true);
+		printer.OpenElement("Z");
+		printer.PushText(z);
+		printer.CloseElement(true);
+		printer.CloseElement();
+	}
+	void FacadeWriter::writeSplits(const char* element, const std::vector<float>& splits)
+	{
+		printer.OpenElement(element);
+		for (float s : splits)
+		{
+			printer.OpenElement("float");
+			printer.PushText(s);
+			printer.CloseElement(true);
+		}
+		printer.CloseElement();
+	}
+	/*********************************************************************************************
+	 * writeShape writes the block of rows [r0, r1) and columns [c0, c1).  A single cell
+	 * 	is a terminal.  Otherwise the block is split along ax, or the other axis if
+	 * 	the block is one cell wide along ax.  While nest > 0 runs longer than two
+	 * 	are halved, otherwise they are split into single rows or cells.
+	 *********************************************************************************************/
+	void FacadeWriter::writeShape(const char* element, unsigned r0, unsigned r1, unsigned c0, unsigned c1,
+			Axis ax, unsigned nest, int level)
+	{
+		bool terminal { r1 - r0 == 1 && c1 - c0 == 1};
+		if (!terminal && ((ax == X) ? c1 - c0 : r1 - r0) == 1) {
+			ax = (ax == X) ? Y : X;
+		}
+		unsigned first { (ax == X) ? c0 : r0};
+		unsigned last { (ax == X) ? c1 : r1};
+		// child boundaries along ax as grid indices
+		std::vector<unsigned> bounds {first};
+		if (!terminal) {
+			if (nest > 0 && last - first > 2) {
+				bounds.push_back(first + (last - first) / 2);
+			}
+			else {
+				for (unsigned i {first + 1}; i < last; ++i)
+				{
+					bounds.push_back(i);
+				}
+			}
+		}
+		bounds.push_back(last);
+		const std::vector<float>& edges { (ax == X) ? xs : ys};
+		std::vector<float> splits;
+		for (std::vector<unsigned>::size_type i {1}; i + 1 < bounds.size(); ++i)
+		{
+			splits.push_back(edges[bounds[i]]);
+		}
+
+		printer.OpenElement(element);
+		printer.OpenElement("Name");
+		printer.PushText(("ShapeId " + std::to_string(r0) + " " + std::to_string(c0) + " 0").c_str());
+		printer.CloseElement(true);
+		printer.OpenElement("MaterialName");
+		printer.PushText("Default");
+		printer.CloseElement(true);
+		printer.OpenElement("Level");
+		printer.PushText(level);
+		printer.CloseElement(true);
+		printer.OpenElement("UId");
+		printer.PushText(uid++);
+		printer.CloseElement(true);
+		printer.OpenElement("Groups");
+		printer.PushText(-1);
+		printer.CloseElement(true);
+		printer.OpenElement("Isolated");
+		printer.PushText(0);
+		printer.CloseElement(true);
+		printer.OpenElement("BBox");
+		writeVector("Min", xs[c0], ys[r0], 0.f);
+		writeVector("Max", xs[c1], ys[r1], 0.3f);
+		writeVector("Size", xs[c1] - xs[c0], ys[r1] - ys[r0], 0.3f);
+		printer.CloseElement();
+		printer.OpenElement("Label");
+		printer.OpenElement("LabelID");
+		printer.PushText(terminal ? 0 : 1);
+		printer.CloseElement(true);
+		printer.OpenElement("LabelName");
+		printer.PushText(terminal ? labels[r0 * params.cols + c0].c_str() : (level == 0) ? "building" : "group");
+		printer.CloseElement(true);
+		printer.CloseElement();
+		printer.OpenElement("Children");
+		for (std::vector<unsigned>::size_type i {0}; !terminal && i + 1 < bounds.size(); ++i)
+		{
+			Axis next { (ax == X) ? Y : X};
+			unsigned childNest { (bounds.size() == 3 && nest > 0) ? nest - 1 : nest};
+			if (ax == X) {
+				writeShape("SerializableShape", r0, r1, bounds[i], bounds[i + 1], next, childNest, level + 1);
+			}
+			else {
+				writeShape("SerializableShape", bounds[i], bounds[i + 1], c0, c1, next, childNest, level + 1);
+			}
+		}
+		printer.CloseElement();
+		writeSplits("SplitsX", (ax == X && !terminal) ? splits : std::vector<float>());
+		writeSplits("SplitsY", (ax == Y && !terminal) ? splits : std::vector<float>());
+		printer.CloseElement();
+	}
+}
+
+void Layout::writeSyntheticFacade(const SyntheticFacade& params, FILE* fp)
+{
+	FacadeWriter writer(params, fp);
+	writer.write();
+}
+
+void Layout::writeSyntheticFacade(const SyntheticFacade& params, const std::string& filename)
+{
+	FILE* fp { fopen(filename.c_str(), "w")};
+	if (fp == nullptr) {
+		throw std::runtime_error("could not open " + filename);
+	}
+	writeSyntheticFacade(params, fp);
+	fclose(fp);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdio>
+#include <string>
+namespace Layout {
+/*****************************************************************************************************
+ * @struct   SyntheticFacade
+ * @brief    parameters of a generated SerializableFacade.  The facade is a grid
+ * 	     of rows x cols terminals.  The labels repeat in tiles of
+ * 	     tileRows x tileCols cells; column widths and row heights repeat
+ * 	     with the same tile so repeated labels also have repeated sizes.
+ * @params   rows, cols     grid size; rows * cols terminals
+ *           tileRows, tileCols  size of the repeating tile of labels
+ *           repeatRate     probability [0, 1] that a cell keeps the tile
+ *           		    label.  Otherwise it gets a label used nowhere
+ *           		    else.  1 is a perfectly periodic facade, 0 has no
+ *           		    repeats at all.
+ *           depth          nesting depth.  0 is a flat grid: the root splits
+ *           		    into rows and each row into cells.  Each extra
+ *           		    level halves runs of rows or cells into nested
+ *           		    groups before they are split into singles.
+ *           seed           seed of the label shuffling.
+ * ***************************************************************************************************/
+	struct SyntheticFacade {
+		unsigned rows {10};
+		unsigned cols {10};
+		unsigned tileRows {2};
+		unsigned tileCols {3};
+		float    repeatRate {1.0f};
+		unsigned depth {0};
+		unsigned seed {660};
+	};
+/*****************************************************************************************************
+ * @func     writeSyntheticFacade writes a SerializableFacade with MainShape,
+ * 		SerializableShape children, BBox, SplitsX/SplitsY, Level, UId and
+ * 		Label nodes that BottomUp can read.
+ * @params[in]  params  the grid to generate
+ *              fp      open file to write to
+ * ***************************************************************************************************/
+	void writeSyntheticFacade(const SyntheticFacade& params, FILE* fp);
+	// opens filename, writes the facade and closes it.  throws on failure
+	void writeSyntheticFacade(const SyntheticFacade& params, const std::string& filename);
+}
@@ -0,0 +1,92 @@
+#include "termSet.h"
+#include <algorithm>
+
+TermSet::TermSet(): first{0}, words{}
+{}
+TermSet::TermSet(unsigned term): first{term / WordBits}, words{Word{1} << (term % WordBits)}
+{}
+
+TermSet::Word TermSet::word(unsigned w) const
+{
+	if (w < first || w - first >= words.size()) {
+		return 0;
+	}
+	return words[w - first];
+}
+
+void TermSet::unite(const TermSet& other)
+{
+	if (other.words.empty()) {
+		return;
+	}
+	if (words.empty()) {
+		*this = other;
+		return;
+	}
+	unsigned lo { std::min(first, other.first)};
+	unsigned hi { std::max(first + static_cast<unsigned>(words.size()),
+			other.first + static_cast<unsigned>(other.words.size()))};
+	if (lo == first && hi == first + words.size()) {
+		// other falls within the words already stored
+		for (std::vector<Word>::size_type i {0}; i < other.words.size(); ++i)
+		{
+			words[other.first - first + i] |= other.words[i];
+		}
+		return;
+	}
+	std::vector<Word> united(hi - lo);
+	for (unsigned w {lo}; w < hi; ++w)
+	{
+		united[w - lo] = word(w) | other.word(w);
+	}
+	first = lo;
+	words = std::move(united);
+}
+
+bool TermSet::intersects(const TermSet& other) const
+{
+	unsigned lo { std::max(first, other.first)};
+	unsigned hi { std::min(first + static_cast<unsigned>(words.size()),
+			other.first + static_cast<unsigned>(other.words.size()))};
+	for (unsigned w {lo}; w < hi; ++w)
+	{
+		if ((words[w - first] & other.words[w - other.first]) != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TermSet::contains(const TermSet& other) const
+{
+	for (std::vector<Word>::size_type i {0}; i < other.words.size(); ++i)
+	{
+		Word o { other.words[i]};
+		if ((o & ~word(other.first + static_cast<unsigned>(i))) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned TermSet::count() const
+{
+	unsigned n {0};
+	for (Word w : words)
+	{
+		for (; w != 0; w &= w - 1) {
+			++n;
+		}
+	}
+	return n;
+}
+
+bool TermSet::empty() const
+{
+	return words.empty();
+}
+
+bool operator==(const TermSet& a, const TermSet& b)
+{
+	return a.first == b.first && a.words == b.words;
+}
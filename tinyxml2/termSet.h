@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+// TermSet is the set of terminals a node of the location tree or a group
+// covers.  Terminals are numbered in the order the location tree is built so the
+// terminals of one region have nearby numbers; the set stores only the words from
+// the first to the last terminal it holds.  Overlap, containment and counting are
+// word by word ands instead of Efloat box tests.
+class TermSet
+{
+public:
+	TermSet();
+	// the set with only terminal term
+	explicit TermSet(unsigned term);
+	// adds all the terminals in other
+	void unite(const TermSet& other);
+	// true if both sets share a terminal
+	bool intersects(const TermSet& other) const;
+	// true if every terminal in other is in this set
+	bool contains(const TermSet& other) const;
+	// number of terminals in the set
+	unsigned count() const;
+	bool empty() const;
+	friend bool operator==(const TermSet& a, const TermSet& b);
+private:
+	typedef std::uint64_t Word;
+	static constexpr unsigned WordBits {64};
+	// words[0] holds terminals first * WordBits to first * WordBits + 63.
+	// the first and last words are never zero.
+	unsigned first;
+	std::vector<Word> words;
+	// the word holding terminals w * WordBits.., zero outside the stored range
+	Word word(unsigned w) const;
+};
+bool operator==(const TermSet& a, const TermSet& b);
@@ -0,0 +1,129 @@
+#include "tileRepeats.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+	typedef std::uint64_t Hash;
+	// odd bases; the hashes wrap modulo 2^64
+	const Hash RowBase {0x9E3779B97F4A7C15ull};
+	const Hash ColBase {0xC2B2AE3D27D4EB4Full};
+
+	// spreads the bits of a symbol so nearby uids hash far apart
+	Hash spreadHash(unsigned s)
+	{
+		Hash h { static_cast<Hash>(s) + 0x9E3779B97F4A7C15ull};
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+		return h ^ (h >> 31);
+	}
+
+	// true if the rows x cols blocks at a and b hold the same symbols
+	bool sameBlock(const std::vector<unsigned>& grid, unsigned width, std::pair<unsigned, unsigned> a,
+			std::pair<unsigned, unsigned> b, unsigned rows, unsigned cols)
+	{
+		for (unsigned r {0}; r < rows; ++r)
+		{
+			std::vector<unsigned>::const_iterator ra { grid.begin() + (a.first + r) * width + a.second};
+			std::vector<unsigned>::const_iterator rb { grid.begin() + (b.first + r) * width + b.second};
+			if (!std::equal(ra, ra + cols, rb)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// sorts the positions of one block size into tiles by their hashes and
+	// keeps those that occur more than once.  Returns true if any does.
+	bool collectTiles(const std::vector<unsigned>& grid, unsigned gridRows, unsigned gridCols,
+			unsigned rows, unsigned cols, const std::vector<Hash>& blockHash,
+			std::vector<Layout::RepeatTile>& tiles)
+	{
+		std::vector<Layout::RepeatTile> found;
+		// the tiles in found with each hash; more than one only on a collision
+		std::unordered_map<Hash, std::vector<std::vector<Layout::RepeatTile>::size_type>> buckets;
+		for (unsigned r {0}; r + rows <= gridRows; ++r)
+		{
+			for (unsigned c {0}; c + cols <= gridCols; ++c)
+			{
+				std::pair<unsigned, unsigned> at {r, c};
+				std::vector<std::vector<Layout::RepeatTile>::size_type>& bucket {
+					buckets[blockHash[r * gridCols + c]]};
+				bool placed {false};
+				for (std::vector<Layout::RepeatTile>::size_type i : bucket)
+				{
+					if (sameBlock(grid, gridCols, found[i].starts.front(), at, rows, cols)) {
+						found[i].starts.push_back(at);
+						placed = true;
+						break;
+					}
+				}
+				if (!placed) {
+					bucket.push_back(found.size());
+					found.push_back(Layout::RepeatTile{rows, cols, {at}});
+				}
+			}
+		}
+		bool repeats {false};
+		for (Layout::RepeatTile& tile : found)
+		{
+			if (tile.starts.size() > 1) {
+				repeats = true;
+				if (rows * cols > 1) {
+					tiles.push_back(std::move(tile));
+				}
+			}
+		}
+		return repeats;
+	}
+}
+
+std::vector<Layout::RepeatTile> Layout::repeatedTiles(const std::vector<unsigned>& grid,
+		unsigned rows, unsigned cols, std::uint64_t (*symbolHash)(unsigned))
+{
+	if (symbolHash == nullptr) {
+		symbolHash = spreadHash;
+	}
+	std::vector<RepeatTile> tiles;
+	// rowHash[r * cols + c] is the hash of the w symbols from (r, c); it is
+	// extended by one symbol for each w
+	std::vector<Hash> rowHash(grid.size(), 0);
+	for (unsigned w {1}; w <= cols; ++w)
+	{
+		for (unsigned r {0}; r < rows; ++r)
+		{
+			for (unsigned c {0}; c + w <= cols; ++c)
+			{
+				Hash& h { rowHash[r * cols + c]};
+				h = h * RowBase + symbolHash(grid[r * cols + c + w - 1]);
+			}
+		}
+		// blockHash[r * cols + c] is the hash of the h rows of width w
+		// from (r, c); it is extended by one row for each h
+		std::vector<Hash> blockHash(grid.size(), 0);
+		bool rowRepeats {false};
+		for (unsigned h {1}; h <= rows; ++h)
+		{
+			for (unsigned r {0}; r + h <= rows; ++r)
+			{
+				for (unsigned c {0}; c + w <= cols; ++c)
+				{
+					Hash& b { blockHash[r * cols + c]};
+					b = b * ColBase + rowHash[(r + h - 1) * cols + c];
+				}
+			}
+			// a taller block repeats only if this one does
+			if (!collectTiles(grid, rows, cols, h, w, blockHash, tiles)) {
+				break;
+			}
+			rowRepeats = rowRepeats || h == 1;
+		}
+		// a wider block repeats only if a single row of this width does
+		if (!rowRepeats) {
+			break;
+		}
+	}
+	std::stable_sort(tiles.begin(), tiles.end(), [](const RepeatTile& a, const RepeatTile& b)
+			{ return a.rows < b.rows || (a.rows == b.rows && a.cols < b.cols);});
+	return tiles;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+namespace Layout {
+/*****************************************************************************************************
+ * @struct   RepeatTile
+ * @brief    one rectangular block of rows x cols cells of a grid that occurs at
+ * 	     every (row, col) in starts with the same symbols.
+ * ***************************************************************************************************/
+	struct RepeatTile {
+		unsigned rows;
+		unsigned cols;
+		std::vector<std::pair<unsigned, unsigned>> starts;  // (row, col), ascending
+	};
+/*****************************************************************************************************
+ * @func     repeatedTiles finds every block of at least two cells that occurs at
+ * 		least twice in a grid.  Each block size is hashed at every position
+ * 		in one pass: the hash of a rows x cols block is rolled from the
+ * 		rows - 1 x cols block above it, and the row hashes of width cols
+ * 		from those of width cols - 1.  Positions with equal hashes are then
+ * 		compared cell by cell, so a hash collision never joins different
+ * 		blocks.  A block can only repeat if its smaller blocks do, so a
+ * 		size with no repeats ends the search in that direction.
+ * @params[in]  grid        rows * cols symbols, row major.  Symbols that occur
+ * 			    once, such as a hole where no single cell fits, keep
+ * 			    blocks from spanning the hole.
+ * 		rows, cols  the grid size
+ * 		symbolHash  hashes one symbol; nullptr spreads its bits.  A poor
+ * 			    hash only costs time, so tests pass one to force
+ * 			    collisions.
+ * @return      the tiles ordered by rows, then cols, then first start.  Every
+ * 		tile of one row precedes the taller tiles.  Occurrences may overlap.
+ * ***************************************************************************************************/
+	std::vector<RepeatTile> repeatedTiles(const std::vector<unsigned>& grid, unsigned rows, unsigned cols,
+			std::uint64_t (*symbolHash)(unsigned) = nullptr);
+}
@@ -31,6 +31,18 @@ distribution.
 #   include <cstddef>
 #   include <cstdarg>
 #endif
+#include <float.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define TIXML_MMAP
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   if !defined(MAP_ANONYMOUS)
+#       define MAP_ANONYMOUS MAP_ANON
+#   endif
+#endif
 
 #if defined(_MSC_VER) && (_MSC_VER >= 1400 ) && (!defined WINCE)
 	// Microsoft Visual Studio, version 2005 and higher. Not WinCE.
@@ -235,6 +247,18 @@ char* StrPair::ParseName( char* p )
 }
 
 
+void StrPair::Intern( XMLNameTable* names )
+{
+    TIXMLASSERT( names );
+    TIXMLASSERT( _start );
+    const size_t len = _end - _start;
+    const char* str = names->Intern( _start, len );
+    Reset();
+    _start = const_cast<char*>( str );
+    _end = _start + len;
+}
+
+
 void StrPair::CollapseWhitespace()
 {
     // Adjusting _start would cause undefined behavior on delete[]
@@ -365,6 +389,119 @@ const char* StrPair::GetStr()
 }
 
 
+// --------- XMLNameTable ----------- //
+
+XMLNameTable::XMLNameTable() :
+    _slots( 0 ),
+    _nSlots( 0 ),
+    _count( 0 ),
+    _chunks(),
+    _free( 0 ),
+    _nFree( 0 )
+{
+}
+
+
+const size_t XMLNameTable::INITIAL_SLOTS;
+const size_t XMLNameTable::CHUNK_SIZE;
+
+
+XMLNameTable::~XMLNameTable()
+{
+    delete [] _slots;
+    for( int i = 0; i < _chunks.Size(); ++i ) {
+        delete [] _chunks[i];
+    }
+}
+
+
+size_t XMLNameTable::Hash( const char* str, size_t len )
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for( size_t i = 0; i < len; ++i ) {
+        hash = ( hash ^ static_cast<unsigned char>( str[i] ) ) * 16777619u;
+    }
+    return hash;
+}
+
+
+size_t XMLNameTable::Probe( const char* str, size_t len, size_t hash ) const
+{
+    TIXMLASSERT( _nSlots > 0 );
+    const size_t mask = _nSlots - 1;
+    size_t i = hash & mask;
+    while ( _slots[i].str ) {
+        const Slot& slot = _slots[i];
+        if ( slot.hash == hash && slot.len == len && memcmp( slot.str, str, len ) == 0 ) {
+            break;
+        }
+        i = ( i + 1 ) & mask;
+    }
+    return i;
+}
+
+
+void XMLNameTable::Grow()
+{
+    Slot* const old = _slots;
+    const size_t nOld = _nSlots;
+    _nSlots = nOld ? nOld * 2 : INITIAL_SLOTS;
+    _slots = new Slot[_nSlots];
+    memset( _slots, 0, _nSlots * sizeof( Slot ) );
+    for( size_t i = 0; i < nOld; ++i ) {
+        if ( old[i].str ) {
+            _slots[Probe( old[i].str, old[i].len, old[i].hash )] = old[i];
+        }
+    }
+    delete [] old;
+}
+
+
+const char* XMLNameTable::Store( const char* str, size_t len )
+{
+    if ( len + 1 > _nFree ) {
+        const size_t size = len + 1 > CHUNK_SIZE ? len + 1 : CHUNK_SIZE;
+        _free = new char[size];
+        _nFree = size;
+        _chunks.Push( _free );
+    }
+    char* const copy = _free;
+    memcpy( copy, str, len );
+    copy[len] = 0;
+    _free += len + 1;
+    _nFree -= len + 1;
+    return copy;
+}
+
+
+const char* XMLNameTable::Intern( const char* str, size_t len )
+{
+    // Keep the load under a half so probes stay short.
+    if ( ( _count + 1 ) * 2 > _nSlots ) {
+        Grow();
+    }
+    const size_t hash = Hash( str, len );
+    Slot& slot = _slots[Probe( str, len, hash )];
+    if ( !slot.str ) {
+        slot.str = Store( str, len );
+        slot.len = len;
+        slot.hash = hash;
+        ++_count;
+    }
+    return slot.str;
+}
+
+
+const char* XMLNameTable::Find( const char* str, size_t len ) const
+{
+    if ( _count == 0 ) {
+        return 0;
+    }
+    return _slots[Probe( str, len, Hash( str, len ) )].str;
+}
+
+
 
 
 // --------- XMLUtil ----------- //
@@ -624,8 +761,128 @@ bool XMLUtil::ToBool( const char* str, bool* value )
 }
 
 
+/*
+	Reads [space][sign]digits[.digits][e[sign]digits] without sscanf or the
+	locale; the decimal point is always '.'. Number heavy documents spend
+	most of their load time here. It only handles what it converts exactly:
+	at most 19 significant digits and a value m * 10^e with m <= 2^53 and
+	|e| <= 22, where m and 10^e are exact doubles and one multiply or divide
+	rounds correctly (Clinger's fast path). Anything else -- inf, nan, hex,
+	long or huge numbers -- returns false and the caller uses sscanf.
+*/
+static bool FastToDouble( const char* p, double* value )
+{
+#if defined( FLT_EVAL_METHOD ) && FLT_EVAL_METHOD == 0
+    static const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    while ( isspace( static_cast<unsigned char>( *p ) ) ) {
+        ++p;
+    }
+    bool negative = false;
+    if ( *p == '-' || *p == '+' ) {
+        negative = ( *p == '-' );
+        ++p;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+    for ( ; *p >= '0' && *p <= '9'; ++p ) {
+        anyDigit = true;
+        if ( mantissa == 0 && *p == '0' ) {
+            continue;
+        }
+        if ( ++digits > 19 ) {
+            return false;
+        }
+        mantissa = mantissa * 10 + ( *p - '0' );
+    }
+    if ( *p == 'x' || *p == 'X' ) {
+        return false;
+    }
+    if ( *p == '.' ) {
+        for ( ++p; *p >= '0' && *p <= '9'; ++p ) {
+            anyDigit = true;
+            --exponent;
+            if ( mantissa == 0 && *p == '0' ) {
+                continue;
+            }
+            if ( ++digits > 19 ) {
+                return false;
+            }
+            mantissa = mantissa * 10 + ( *p - '0' );
+        }
+    }
+    if ( !anyDigit ) {
+        return false;
+    }
+    if ( *p == 'e' || *p == 'E' ) {
+        ++p;
+        bool negativeExponent = false;
+        if ( *p == '-' || *p == '+' ) {
+            negativeExponent = ( *p == '-' );
+            ++p;
+        }
+        if ( *p < '0' || *p > '9' ) {
+            return false;
+        }
+        int e = 0;
+        for ( ; *p >= '0' && *p <= '9'; ++p ) {
+            if ( e < 10000 ) {
+                e = e * 10 + ( *p - '0' );
+            }
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    double d = 0;
+    if ( mantissa != 0 ) {
+        if ( mantissa > ( (uint64_t)1 << 53 ) || exponent < -22 || exponent > 22 ) {
+            return false;
+        }
+        d = static_cast<double>( mantissa );
+        d = ( exponent < 0 ) ? d / powersOf10[-exponent] : d * powersOf10[exponent];
+    }
+    *value = negative ? -d : d;
+    return true;
+#else
+    // extended precision intermediates would round twice
+    (void)p;
+    (void)value;
+    return false;
+#endif
+}
+
+
+/*
+	FastToDouble then rounded to float. That rounds twice, which is only
+	wrong when the double lies exactly halfway between two floats, so
+	that case goes to sscanf. Values from the fast path are between 1e-22
+	and 1e38 and are always normal floats.
+*/
+static bool FastToFloat( const char* p, float* value )
+{
+    double d = 0;
+    if ( !FastToDouble( p, &d ) ) {
+        return false;
+    }
+    uint64_t bits = 0;
+    memcpy( &bits, &d, sizeof( bits ) );
+    // the 29 mantissa bits a float drops are 1000...0
+    if ( ( bits & 0x1FFFFFFF ) == 0x10000000 ) {
+        return false;
+    }
+    *value = static_cast<float>( d );
+    return true;
+}
+
+
 bool XMLUtil::ToFloat( const char* str, float* value )
 {
+    if ( FastToFloat( str, value ) ) {
+        return true;
+    }
     if ( TIXML_SSCANF( str, "%f", value ) == 1 ) {
         return true;
     }
@@ -635,6 +892,9 @@ bool XMLUtil::ToFloat( const char* str, float* value )
 
 bool XMLUtil::ToDouble( const char* str, double* value )
 {
+    if ( FastToDouble( str, value ) ) {
+        return true;
+    }
     if ( TIXML_SSCANF( str, "%lf", value ) == 1 ) {
         return true;
     }
@@ -770,6 +1030,13 @@ const char* XMLNode::Value() const
 
 void XMLNode::SetValue( const char* str, bool staticMem )
 {
+    if ( ToElement() ) {
+        // Set() only records where str is; Intern() copies it to the table
+        char* const name = const_cast<char*>( str );
+        _value.Set( name, name + strlen( str ), 0 );
+        _value.Intern( &_document->_names );
+        return;
+    }
     if ( staticMem ) {
         _value.SetInternedStr( str );
     }
@@ -949,6 +1216,18 @@ const XMLElement* XMLNode::FirstChildElement( const char* name ) const
 }
 
 
+const XMLElement* XMLNode::FirstChildElement( XMLName name ) const
+{
+    for( const XMLNode* node = _firstChild; node; node = node->_next ) {
+        const XMLElement* element = node->ToElementWithName( name );
+        if ( element ) {
+            return element;
+        }
+    }
+    return 0;
+}
+
+
 const XMLElement* XMLNode::LastChildElement( const char* name ) const
 {
     for( const XMLNode* node = _lastChild; node; node = node->_prev ) {
@@ -973,6 +1252,18 @@ const XMLElement* XMLNode::NextSiblingElement( const char* name ) const
 }
 
 
+const XMLElement* XMLNode::NextSiblingElement( XMLName name ) const
+{
+    for( const XMLNode* node = _next; node; node = node->_next ) {
+        const XMLElement* element = node->ToElementWithName( name );
+        if ( element ) {
+            return element;
+        }
+    }
+    return 0;
+}
+
+
 const XMLElement* XMLNode::PreviousSiblingElement( const char* name ) const
 {
     for( const XMLNode* node = _prev; node; node = node->_prev ) {
@@ -1143,6 +1434,16 @@ const XMLElement* XMLNode::ToElementWithName( const char* name ) const
     return 0;
 }
 
+const XMLElement* XMLNode::ToElementWithName( XMLName name ) const
+{
+    // Only element names are interned, so the virtual ToElement() is
+    // left for the node that matches.
+    if ( name.Empty() || !_value.IsInterned( name.Str() ) ) {
+        return 0;
+    }
+    return this->ToElement();
+}
+
 // --------- XMLText ---------- //
 char* XMLText::ParseDeep( char* p, StrPair*, int* curLineNumPtr )
 {
@@ -1722,6 +2023,19 @@ XMLError XMLElement::QueryFloatText( float* fval ) const
     return XML_NO_TEXT_NODE;
 }
 
+int XMLElement::QueryFloatChildTexts( float* values, int maxCount ) const
+{
+    int count = 0;
+    for ( const XMLNode* child = FirstChild(); child && count < maxCount; child = child->NextSibling() ) {
+        const XMLElement* element = child->ToElement();
+        if ( !element || element->QueryFloatText( values + count ) != XML_SUCCESS ) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
 int XMLElement::IntText(int defaultValue) const
 {
 	int i = defaultValue;
@@ -1912,6 +2226,7 @@ char* XMLElement::ParseDeep( char* p, StrPair* parentEndTag, int* curLineNumPtr
     if ( _value.Empty() ) {
         return 0;
     }
+    _value.Intern( &_document->_names );
 
     p = ParseAttributes( p, curLineNumPtr );
     if ( !p || !*p || _closingType != OPEN ) {
@@ -2012,6 +2327,10 @@ XMLDocument::XMLDocument( bool processEntities, Whitespace whitespaceMode ) :
     _errorStr(),
     _errorLineNum( 0 ),
     _charBuffer( 0 ),
+    _charBufferMapped( 0 ),
+    _charBufferSize( 0 ),
+    _spareBuffer( 0 ),
+    _spareBufferSize( 0 ),
     _parseCurLineNum( 0 ),
 	_parsingDepth(0),
     _unlinked(),
@@ -2045,6 +2364,61 @@ void XMLDocument::MarkInUse(XMLNode* node)
 }
 
 void XMLDocument::Clear()
+{
+    ClearDocument();
+    delete [] _spareBuffer;
+    _spareBuffer = 0;
+    _spareBufferSize = 0;
+}
+
+
+void XMLDocument::Reset()
+{
+    if ( _charBuffer && !_charBufferMapped && _charBufferSize > _spareBufferSize ) {
+        delete [] _spareBuffer;
+        _spareBuffer = _charBuffer;
+        _spareBufferSize = _charBufferSize;
+        _charBuffer = 0;
+        _charBufferSize = 0;
+    }
+    ClearDocument();
+    _elementPool.Reset();
+    _attributePool.Reset();
+    _textPool.Reset();
+    _commentPool.Reset();
+}
+
+
+XMLName XMLDocument::Intern( const char* name )
+{
+    TIXMLASSERT( name );
+    return XMLName( _names.Intern( name, strlen( name ) ) );
+}
+
+
+XMLName XMLDocument::FindName( const char* name ) const
+{
+    TIXMLASSERT( name );
+    return XMLName( _names.Find( name, strlen( name ) ) );
+}
+
+
+void XMLDocument::AllocCharBuffer( size_t size )
+{
+    TIXMLASSERT( _charBuffer == 0 );
+    if ( _spareBuffer && _spareBufferSize >= size ) {
+        _charBuffer = _spareBuffer;
+        _charBufferSize = _spareBufferSize;
+        _spareBuffer = 0;
+        _spareBufferSize = 0;
+        return;
+    }
+    _charBuffer = new char[size];
+    _charBufferSize = size;
+}
+
+
+void XMLDocument::ClearDocument()
 {
     DeleteChildren();
 	while( _unlinked.Size()) {
@@ -2056,8 +2430,16 @@ void XMLDocument::Clear()
 #endif
     ClearError();
 
+#ifdef TIXML_MMAP
+    if ( _charBufferMapped ) {
+        munmap( _charBuffer, _charBufferMapped );
+        _charBuffer = 0;
+        _charBufferMapped = 0;
+    }
+#endif
     delete [] _charBuffer;
     _charBuffer = 0;
+    _charBufferSize = 0;
 	_parsingDepth = 0;
 
 #if 0
@@ -2172,7 +2554,7 @@ XMLError XMLDocument::LoadFile( const char* filename )
         return _errorID;
     }
 
-    Clear();
+    ClearDocument();
     FILE* fp = callfopen( filename, "rb" );
     if ( !fp ) {
         SetError( XML_ERROR_FILE_NOT_FOUND, 0, "filename=%s", filename );
@@ -2183,6 +2565,68 @@ XMLError XMLDocument::LoadFile( const char* filename )
     return _errorID;
 }
 
+XMLError XMLDocument::LoadFileMapped( const char* filename )
+{
+#ifdef TIXML_MMAP
+    if ( !filename ) {
+        TIXMLASSERT( false );
+        SetError( XML_ERROR_FILE_COULD_NOT_BE_OPENED, 0, "filename=<null>" );
+        return _errorID;
+    }
+
+    ClearDocument();
+    const int fd = open( filename, O_RDONLY );
+    if ( fd < 0 ) {
+        SetError( XML_ERROR_FILE_NOT_FOUND, 0, "filename=%s", filename );
+        return _errorID;
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) ) {
+        // pipes and devices have no size to map
+        close( fd );
+        return LoadFile( filename );
+    }
+    if ( st.st_size == 0 ) {
+        close( fd );
+        SetError( XML_ERROR_EMPTY_DOCUMENT, 0, 0 );
+        return _errorID;
+    }
+    const size_t size = static_cast<size_t>( st.st_size );
+    const size_t page = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+    // at least one byte past the file, for the null terminator
+    const size_t mapped = ( size / page + 1 ) * page;
+    // Reserve zeroed pages, then map the file privately over the front of
+    // them: the byte after the file is 0 even when the file fills its last
+    // page, and the pages the parser writes to are copied, not the file.
+    void* base = mmap( 0, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( base == MAP_FAILED ) {
+        close( fd );
+        return LoadFile( filename );
+    }
+    int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+    // the parser writes to nearly every page; copying them all in one
+    // pass up front is cheaper than a fault on each first write
+    flags |= MAP_POPULATE;
+#endif
+    if ( mmap( base, size, PROT_READ | PROT_WRITE, flags, fd, 0 ) == MAP_FAILED ) {
+        munmap( base, mapped );
+        close( fd );
+        return LoadFile( filename );
+    }
+    close( fd );
+    TIXMLASSERT( _charBuffer == 0 );
+    _charBuffer = static_cast<char*>( base );
+    _charBufferMapped = mapped;
+    TIXMLASSERT( _charBuffer[size] == 0 );
+
+    Parse();
+    return _errorID;
+#else
+    return LoadFile( filename );
+#endif
+}
+
 // This is likely overengineered template art to have a check that unsigned long value incremented
 // by one still fits into size_t. If size_t type is larger than unsigned long type
 // (x86_64-w64-mingw32 target) then the check is redundant and gcc and clang emit
@@ -2208,7 +2652,7 @@ struct LongFitsIntoSizeTMinusOne<false> {
 
 XMLError XMLDocument::LoadFile( FILE* fp )
 {
-    Clear();
+    ClearDocument();
 
     fseek( fp, 0, SEEK_SET );
     if ( fgetc( fp ) == EOF && ferror( fp ) != 0 ) {
@@ -2237,8 +2681,7 @@ XMLError XMLDocument::LoadFile( FILE* fp )
     }
 
     const size_t size = filelength;
-    TIXMLASSERT( _charBuffer == 0 );
-    _charBuffer = new char[size+1];
+    AllocCharBuffer( size+1 );
     const size_t read = fread( _charBuffer, 1, size, fp );
     if ( read != size ) {
         SetError( XML_ERROR_FILE_READ_ERROR, 0, 0 );
@@ -2284,7 +2727,7 @@ XMLError XMLDocument::SaveFile( FILE* fp, bool compact )
 
 XMLError XMLDocument::Parse( const char* p, size_t len )
 {
-    Clear();
+    ClearDocument();
 
     if ( len == 0 || !p || !*p ) {
         SetError( XML_ERROR_EMPTY_DOCUMENT, 0, 0 );
@@ -2293,8 +2736,7 @@ XMLError XMLDocument::Parse( const char* p, size_t len )
     if ( len == (size_t)(-1) ) {
         len = strlen( p );
     }
-    TIXMLASSERT( _charBuffer == 0 );
-    _charBuffer = new char[ len+1 ];
+    AllocCharBuffer( len+1 );
     memcpy( _charBuffer, p, len );
     _charBuffer[len] = 0;
 
@@ -2325,6 +2767,14 @@ void XMLDocument::Print( XMLPrinter* streamer ) const
 }
 
 
+// the start of every error string, "Error=<name> ErrorID=<id> (0x<id>) Line number=<line>"
+static void PrintErrorHeader( char* buffer, size_t size, XMLError error, int lineNum )
+{
+    TIXML_SNPRINTF( buffer, size, "Error=%s ErrorID=%d (0x%x) Line number=%d",
+                    XMLDocument::ErrorIDToName( error ), int( error ), int( error ), lineNum );
+}
+
+
 void XMLDocument::SetError( XMLError error, int lineNum, const char* format, ... )
 {
     TIXMLASSERT( error >= 0 && error < XML_ERROR_COUNT );
@@ -2336,7 +2786,7 @@ void XMLDocument::SetError( XMLError error, int lineNum, const char* format, ...
     char* buffer = new char[BUFFER_SIZE];
 
     TIXMLASSERT(sizeof(error) <= sizeof(int));
-    TIXML_SNPRINTF(buffer, BUFFER_SIZE, "Error=%s ErrorID=%d (0x%x) Line number=%d", ErrorIDToName(error), int(error), int(error), lineNum);
+    PrintErrorHeader(buffer, BUFFER_SIZE, error, lineNum);
 
 	if (format) {
 		size_t len = strlen(buffer);
@@ -2363,7 +2813,20 @@ void XMLDocument::SetError( XMLError error, int lineNum, const char* format, ...
 
 const char* XMLDocument::ErrorStr() const
 {
-	return _errorStr.Empty() ? "" : _errorStr.GetStr();
+	if ( _errorStr.Empty() ) {
+		if ( _errorID != XML_SUCCESS ) {
+			return "";
+		}
+		// ClearError leaves the string empty; a cleared document reports
+		// the header SetError( XML_SUCCESS, 0, 0 ) would have written
+		struct SuccessStr {
+			char str[64];
+			SuccessStr() { PrintErrorHeader( str, sizeof( str ), XML_SUCCESS, 0 ); }
+		};
+		static const SuccessStr success;
+		return success.str;
+	}
+	return _errorStr.GetStr();
 }
 
 
@@ -123,6 +123,7 @@ class XMLText;
 class XMLDeclaration;
 class XMLUnknown;
 class XMLPrinter;
+class XMLNameTable;
 
 /*
 	A class that wraps strings. Normally stores the start and end
@@ -176,6 +177,12 @@ public:
     char* ParseText( char* in, const char* endTag, int strFlags, int* curLineNumPtr );
     char* ParseName( char* in );
 
+    // Points the string at its copy in names, which equal strings share.
+    void Intern( XMLNameTable* names );
+    bool IsInterned( const char* str ) const {
+        return _start == str;
+    }
+
     void TransferTo( StrPair* other );
 	void Reset();
 
@@ -364,6 +371,27 @@ public:
         _nUntracked = 0;
     }
 
+    // Like Clear(), but keeps the blocks for the next allocations. Every
+    // item has to be free. The free list is rebuilt in block order, so the
+    // next document is laid out like it would be in a new pool.
+    void Reset() {
+        TIXMLASSERT( _currentAllocs == 0 );
+        if ( _currentAllocs != 0 ) {
+            return;
+        }
+        _root = 0;
+        for( int b = _blockPtrs.Size() - 1; b >= 0; --b ) {
+            Item* blockItems = _blockPtrs[b]->items;
+            for( int i = ITEMS_PER_BLOCK - 1; i >= 0; --i ) {
+                blockItems[i].next = _root;
+                _root = &blockItems[i];
+            }
+        }
+        _nAllocs = 0;
+        _maxAllocs = 0;
+        _nUntracked = 0;
+    }
+
     virtual int ItemSize() const	{
         return ITEM_SIZE;
     }
@@ -457,6 +485,76 @@ private:
 };
 
 
+/*
+	The element names of a document, each stored once, so that equal
+	names are the same pointer. Names are only freed with the table.
+*/
+class TINYXML2_LIB XMLNameTable
+{
+public:
+    XMLNameTable();
+    ~XMLNameTable();
+
+    // The table's copy of the len chars at str; added if it is new.
+    const char* Intern( const char* str, size_t len );
+    // The table's copy of the len chars at str, or null.
+    const char* Find( const char* str, size_t len ) const;
+    size_t Size() const {
+        return _count;
+    }
+
+private:
+    XMLNameTable( const XMLNameTable& );	// not supported
+    void operator=( const XMLNameTable& );	// not supported
+
+    struct Slot {
+        const char* str;
+        size_t len;
+        size_t hash;
+    };
+    static size_t Hash( const char* str, size_t len );
+    // The slot holding str, or the empty slot where it would go.
+    size_t Probe( const char* str, size_t len, size_t hash ) const;
+    void Grow();
+    const char* Store( const char* str, size_t len );
+
+    static const size_t INITIAL_SLOTS = 64;
+    static const size_t CHUNK_SIZE = 1024;
+    Slot* _slots;
+    size_t _nSlots;
+    size_t _count;
+    DynArray< char*, 4 > _chunks;
+    char* _free;
+    size_t _nFree;
+};
+
+
+/**
+	An element name interned in one XMLDocument by XMLDocument::Intern().
+	Looking an element up by an XMLName compares pointers instead of strings.
+	An empty XMLName matches no element.
+*/
+class TINYXML2_LIB XMLName
+{
+    friend class XMLDocument;
+public:
+    XMLName() : _str( 0 ) {}
+
+    /// The name, or null for an empty XMLName.
+    const char* Str() const {
+        return _str;
+    }
+    bool Empty() const {
+        return _str == 0;
+    }
+
+private:
+    explicit XMLName( const char* str ) : _str( str ) {}
+
+    const char* _str;
+};
+
+
 
 /**
 	Implements the interface to the "Visitor pattern" (see the Accept() method.)
@@ -736,7 +834,8 @@ public:
     */
     const char* Value() const;
 
-    /** Set the Value of an XML node.
+    /** Set the Value of an XML node. An element name is interned
+        in the document whatever staticMem is.
     	@sa Value()
     */
     void SetValue( const char* val, bool staticMem=false );
@@ -776,6 +875,16 @@ public:
         return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->FirstChildElement( name ));
     }
 
+    /** Get the first child element with an interned name. The names
+        are compared as pointers, so name must come from this node's
+        document; see XMLDocument::Intern().
+    */
+    const XMLElement* FirstChildElement( XMLName name ) const;
+
+    XMLElement* FirstChildElement( XMLName name )	{
+        return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->FirstChildElement( name ));
+    }
+
     /// Get the last child node, or null if none exists.
     const XMLNode*	LastChild() const						{
         return _lastChild;
@@ -826,6 +935,13 @@ public:
         return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->NextSiblingElement( name ) );
     }
 
+    /// Get the next sibling element with an interned name; see FirstChildElement( XMLName ).
+    const XMLElement*	NextSiblingElement( XMLName name ) const;
+
+    XMLElement*	NextSiblingElement( XMLName name )	{
+        return const_cast<XMLElement*>(const_cast<const XMLNode*>(this)->NextSiblingElement( name ) );
+    }
+
     /**
     	Add a child node as the last (right) child.
 		If the child node is already part of the document,
@@ -963,6 +1079,7 @@ private:
     static void DeleteNode( XMLNode* node );
     void InsertChildPreamble( XMLNode* insertThis ) const;
     const XMLElement* ToElementWithName( const char* name ) const;
+    const XMLElement* ToElementWithName( XMLName name ) const;
 
     XMLNode( const XMLNode& );	// not supported
     XMLNode& operator=( const XMLNode& );	// not supported
@@ -1591,6 +1708,21 @@ public:
     /// See QueryIntText()
     XMLError QueryFloatText( float* fval ) const;
 
+    /**
+    	Reads the text of the child elements of a list such as
+
+    	@verbatim
+    		<splits><s>1.5</s><s>4</s><s>7.25</s></splits>
+    	@endverbatim
+
+    	as floats into values, in document order. It stops at the first child
+    	that is not an element or whose text is not a float, and after
+    	maxCount values.
+
+    	@returns the number of values read.
+    */
+    int QueryFloatChildTexts( float* values, int maxCount ) const;
+
 	int IntText(int defaultValue = 0) const;
 
 	/// See QueryIntText()
@@ -1693,6 +1825,20 @@ public:
     */
     XMLError LoadFile( const char* filename );
 
+    /**
+    	Load an XML file from disk without reading it into a new buffer.
+    	The file is mapped copy-on-write and parsed in place: there is no
+    	heap buffer and no read() pass. The parser writes into most pages,
+    	so they end up copied all the same. The mapping is released by
+    	Clear() or the destructor, and the file must not be truncated
+    	while it is mapped.
+    	Falls back to LoadFile() on systems without mmap and for files
+    	that can not be mapped.
+    	Returns XML_SUCCESS (0) on success, or
+    	an errorID.
+    */
+    XMLError LoadFileMapped( const char* filename );
+
     /**
     	Load an XML file from disk. You are responsible
     	for providing and closing the FILE*.
@@ -1812,7 +1958,10 @@ public:
     void DeleteNode( XMLNode* node );
 
     void ClearError() {
-        SetError(XML_SUCCESS, 0, 0);
+        // ErrorStr() spells out XML_SUCCESS itself, so clearing does not allocate
+        _errorID = XML_SUCCESS;
+        _errorLineNum = 0;
+        _errorStr.Reset();
     }
 
     /// Return true if there was an error parsing the document.
@@ -1843,6 +1992,26 @@ public:
     /// Clear the document, resetting it to the initial state.
     void Clear();
 
+    /**
+    	Clear the document but keep its memory for the next LoadFile() or
+    	Parse(): the node pools keep their blocks and the character buffer
+    	is reused by a file that fits in it. Loading many files in a row
+    	with one document then stops allocating once it has seen the
+    	largest. Clear() or the destructor releases the memory.
+    */
+    void Reset();
+
+    /**
+    	Intern an element name for FirstChildElement( XMLName ) and
+    	NextSiblingElement( XMLName ), which compare pointers instead of
+    	strings. Every element name is interned when it is parsed or set.
+    	The handle, and the name, last as long as the document, through
+    	Clear() and Reset(), but only match elements of this document.
+    */
+    XMLName Intern( const char* name );
+    /// Like Intern(), but an empty XMLName if no element was ever given the name.
+    XMLName FindName( const char* name ) const;
+
 	/**
 		Copies this document to a target document.
 		The target will be completely cleared before the copy.
@@ -1869,6 +2038,11 @@ private:
     XMLDocument( const XMLDocument& );	// not supported
     void operator=( const XMLDocument& );	// not supported
 
+    // Clear() except for the spare buffer
+    void ClearDocument();
+    // a new _charBuffer of size bytes; the spare one if it is large enough
+    void AllocCharBuffer( size_t size );
+
     bool			_writeBOM;
     bool			_processEntities;
     XMLError		_errorID;
@@ -1876,6 +2050,11 @@ private:
     mutable StrPair	_errorStr;
     int             _errorLineNum;
     char*			_charBuffer;
+    size_t			_charBufferMapped;	// bytes mapped by LoadFileMapped(), 0 if _charBuffer is new[]
+    size_t			_charBufferSize;	// bytes allocated for _charBuffer by new[]
+    char*			_spareBuffer;		// a _charBuffer kept by Reset() for the next load
+    size_t			_spareBufferSize;
+    XMLNameTable	_names;
     int				_parseCurLineNum;
 	int				_parsingDepth;
 	// Memory tracking does add some overhead.
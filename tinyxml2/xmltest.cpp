@@ -6,11 +6,20 @@
 
 #include "tinyxml2.h"
 #include "parseLayout.h"
+#include "intervalBatch.h"
+#include "suffixRepeats.h"
+#include "syntheticFacade.h"
+#include "tileRepeats.h"
+#include <algorithm>
 #include <cerrno>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
 
 #if defined( _MSC_VER ) || defined (WIN32)
 	#include <crtdbg.h>
@@ -299,6 +308,138 @@ bool example_4()
 */
 
 
+// "length:start,start ..." of each run, in the order found
+std::string runsText(const std::vector<Layout::RepeatRun>& runs)
+{
+	std::ostringstream out;
+	for (const Layout::RepeatRun& run : runs)
+	{
+		out << (out.tellp() > 0 ? " " : "") << run.length << ":";
+		for (std::vector<unsigned>::size_type i = 0; i < run.starts.size(); ++i)
+			out << (i > 0 ? "," : "") << run.starts[i];
+	}
+	return out.str();
+}
+
+// the number of names that start with prefix
+int countNames(const Layout::nameMap& names, const std::string& prefix)
+{
+	int count = 0;
+	for (const Layout::nameMap::value_type& name : names)
+		if (name.first.compare(0, prefix.size(), prefix) == 0)
+			++count;
+	return count;
+}
+
+
+// "RxC:(row,col)(row,col) ..." of each tile, in the order found
+std::string tilesText(const std::vector<Layout::RepeatTile>& tiles)
+{
+	std::ostringstream out;
+	for (const Layout::RepeatTile& tile : tiles)
+	{
+		out << (out.tellp() > 0 ? " " : "") << tile.rows << "x" << tile.cols << ":";
+		for (const std::pair<unsigned, unsigned>& start : tile.starts)
+			out << "(" << start.first << "," << start.second << ")";
+	}
+	return out.str();
+}
+
+// every symbol hashes the same, so every block of one size collides
+std::uint64_t collidingHash(unsigned)
+{
+	return 0;
+}
+
+// true if every tile group of bu holds one terminal per cell, the cells of
+// a row or column are as high or wide as each other, and every row of a
+// tile wider than one cell is a one row tile.  count is the number of tile
+// groups taller than one row.
+bool tilesAreRowsOfCells(const Layout::BottomUp& bu, int& count)
+{
+	count = 0;
+	for (const Layout::GroupMap::value_type& entry : bu.groups)
+	{
+		const Layout::Node& tile = *entry.second.first;
+		unsigned rows = 0, cols = 0;
+		if (sscanf(tile.v->name.c_str(), "Tile %ux%u", &rows, &cols) != 2)
+			continue;
+		if (tile.v->n != rows * cols || tile.children.size() != (rows == 1 ? cols : rows))
+			return false;
+		for (const std::shared_ptr<const Layout::Node>& child : tile.children)
+		{
+			if (rows == 1 && !(child->size.y == tile.children.front()->size.y))
+				return false;
+			if (cols == 1 && !(child->size.x == tile.children.front()->size.x))
+				return false;
+			if (rows > 1 && cols > 1 && child->v->name.compare(0, 7, "Tile 1x") != 0)
+				return false;
+		}
+		if (rows > 1 && cols > 1)
+			++count;
+	}
+	return true;
+}
+
+
+// true if a and b hold groups of the same uids, values, sizes and corners
+// in the same order
+bool sameGroups(const Layout::GroupMap& a, const Layout::GroupMap& b)
+{
+	Layout::GroupMap::const_iterator ib = b.begin();
+	for (const Layout::GroupMap::value_type& entry : a)
+	{
+		if (ib == b.end() || ib->first != entry.first || !(ib->second.second == entry.second.second) ||
+				!(*ib->second.first->v == *entry.second.first->v) || ib->second.first->v->name != entry.second.first->v->name ||
+				!(ib->second.first->size == entry.second.first->size))
+			return false;
+		++ib;
+	}
+	return ib == b.end();
+}
+
+// the corner and split of every split line of the location tree under loc
+void collectSplitLines(const Layout::GroupPair& loc, std::vector<std::pair<Layout::GroupPair, Layout::SplitIt>>& lines)
+{
+	Layout::Vector childMin = loc.second;
+	for (std::vector<Layout::Scalar>::size_type i = 0; i < loc.first->children.size(); ++i)
+	{
+		if (i > 0) {
+			lines.push_back(std::make_pair(loc, loc.first->splits.begin() + (i - 1)));
+			if (loc.first->splitDir == Layout::Vector::Axis::X)
+				childMin.x = loc.second.x + loc.first->splits[i - 1];
+			else
+				childMin.y = loc.second.y + loc.first->splits[i - 1];
+		}
+		collectSplitLines(Layout::GroupPair(loc.first->children[i], childMin), lines);
+	}
+}
+
+
+// true if the batch holds the values and errors of the Efloats bit for bit
+bool sameBits(const Layout::IntervalBatch& batch, const std::vector<Efloat>& fs)
+{
+	if (batch.size() != fs.size())
+		return false;
+	for (std::vector<Efloat>::size_type i = 0; i < fs.size(); ++i)
+		if (float(batch[i]) != float(fs[i]) || batch[i].getAbsoluteError() != fs[i].getAbsoluteError())
+			return false;
+	return true;
+}
+
+
+// true if the location trees below a and b have the same shape, uids and terminals
+bool sameTree(const Layout::Node& a, const Layout::Node& b)
+{
+	if (a.v->uid != b.v->uid || a.v->n != b.v->n || !(a.terms == b.terms) || a.children.size() != b.children.size())
+		return false;
+	for (std::vector<std::shared_ptr<const Layout::Node>>::size_type i = 0; i < a.children.size(); ++i)
+		if (!sameTree(*a.children[i], *b.children[i]))
+			return false;
+	return true;
+}
+
+
 int main( int argc, const char ** argv )
 {
 	#if defined( _MSC_VER ) && defined( TINYXML2_DEBUG )
@@ -318,14 +459,14 @@ int main( int argc, const char ** argv )
 	if ( argc > 1 ) {
 		clock_t startTime = clock();
 		unique_ptr<Layout::BottomUp> bu (new Layout::BottomUp(argv[1]));
-		EVector startSearch {bu -> location.second};
+		Layout::Vector startSearch {bu -> location.second};
 		std::shared_ptr<const Layout::LeafNode> ll { Layout::findLLNode(
 				 bu->location.first, startSearch, bu ->location.second)};
 
 		std::list<std::shared_ptr<const Layout::Node>> XBoxes {
-			ll -> findXYLocMap(EVector::Axis::X, bu->location.first ->size.x)};
+			ll -> findXYLocMap(Layout::Vector::Axis::X, bu->location.first ->size.x)};
 		std::list<std::shared_ptr<const Layout::Node>> YBoxes {
-			ll -> findXYLocMap(EVector::Axis::Y, bu->location.first ->size.y)};
+			ll -> findXYLocMap(Layout::Vector::Axis::Y, bu->location.first ->size.y)};
 		Layout::BottomUp copy(*bu);
 		bu = nullptr;
  		clock_t loadTime = clock();
@@ -565,6 +706,94 @@ int main( int argc, const char ** argv )
 
 		//gNewTotal = gNew - newStart;
 	}
+	{
+		// LoadFileMapped parses the same tree as LoadFile
+		XMLDocument doc, mapped;
+		doc.LoadFile( "resources/dream.xml" );
+		mapped.LoadFileMapped( "resources/dream.xml" );
+		XMLTest( "Load mapped dream.xml", false, mapped.Error() );
+		XMLPrinter printer, mappedPrinter;
+		doc.Print( &printer );
+		mapped.Print( &mappedPrinter );
+		XMLTest( "Mapped dream.xml", printer.CStr(), mappedPrinter.CStr(), false );
+		// a reload unmaps the last file
+		mapped.LoadFileMapped( "resources/dream.xml" );
+		XMLTest( "Reload mapped dream.xml", false, mapped.Error() );
+
+		// a file that fills its last page still gets a null terminator
+		FILE* fp = fopen( "resources/out/mappedpage.xml", "w" );
+		fputs( "<page>", fp );
+		for ( int i = 0; i < 4096 - 13; ++i ) {
+			fputc( 'x', fp );
+		}
+		fputs( "</page>", fp );
+		fclose( fp );
+		mapped.LoadFileMapped( "resources/out/mappedpage.xml" );
+		XMLTest( "Mapped whole page", false, mapped.Error() );
+		XMLTest( "Mapped whole page text", 4096 - 13, (int)strlen( mapped.RootElement()->GetText() ) );
+
+		mapped.LoadFileMapped( "resources/no-such-file.xml" );
+		XMLTest( "Mapped missing file", XML_ERROR_FILE_NOT_FOUND, mapped.ErrorID() );
+	}
+	{
+		// Reset keeps the pools and the character buffer for the next load
+		XMLDocument doc, reused;
+		doc.LoadFile( "resources/dream.xml" );
+		reused.LoadFileMapped( "resources/dream.xml" );
+		reused.Reset();
+		XMLTest( "Reset empties the document", true, reused.NoChildren() );
+		XMLTest( "Reset clears the error", XML_SUCCESS, reused.ErrorID() );
+		XMLPrinter printer;
+		doc.Print( &printer );
+		for ( int i = 0; i < 3; ++i ) {
+			reused.Reset();
+			reused.Parse( "<a><b c='1'/>text<!--comment--></a>" );
+			reused.Reset();
+			reused.LoadFile( "resources/dream.xml" );
+			XMLPrinter reusedPrinter;
+			reused.Print( &reusedPrinter );
+			XMLTest( "Reset and reload dream.xml", printer.CStr(), reusedPrinter.CStr(), false );
+		}
+		XMLTest( "Cleared error string", "Error=XML_SUCCESS ErrorID=0 (0x0) Line number=0", reused.ErrorStr() );
+	}
+	{
+		// Interned names find the same elements as strings
+		XMLDocument doc;
+		doc.Parse( "<a><b/><c/>text<b id='2'/><!--b--><d><b/></d></a>" );
+		const XMLName b = doc.Intern( "b" );
+		const XMLElement* a = doc.FirstChildElement( doc.Intern( "a" ) );
+		XMLTest( "Interned root", true, a == doc.RootElement() );
+		XMLTest( "Interned name is the element name", true, a->FirstChildElement( b )->Name() == b.Str() );
+		XMLTest( "Interned first child", true, a->FirstChildElement( b ) == a->FirstChildElement( "b" ) );
+		XMLTest( "Interned next sibling", 2, a->FirstChildElement( b )->NextSiblingElement( b )->IntAttribute( "id" ) );
+		XMLTest( "Interned last sibling", true, a->FirstChildElement( b )->NextSiblingElement( b )->NextSiblingElement( b ) == 0 );
+		XMLTest( "Interned missing name", true, a->FirstChildElement( doc.Intern( "e" ) ) == 0 );
+		XMLTest( "Empty name", true, a->FirstChildElement( XMLName() ) == 0 );
+		XMLTest( "FindName parsed", true, doc.FindName( "d" ).Str() == doc.Intern( "d" ).Str() );
+		XMLTest( "FindName unknown", true, doc.FindName( "f" ).Empty() );
+
+		// set names are interned too, and handles outlive Reset()
+		XMLElement* c = doc.RootElement()->FirstChildElement( "c" );
+		c->SetName( "b" );
+		XMLTest( "Renamed element", true, a->FirstChildElement( b )->NextSiblingElement( b ) == c );
+		doc.RootElement()->InsertEndChild( doc.NewElement( "f" ) );
+		XMLTest( "Interned new element", true, a->FirstChildElement( doc.FindName( "f" ) ) == a->LastChildElement() );
+		doc.Reset();
+		doc.Parse( "<a><x/><b/></a>" );
+		XMLTest( "Interned after Reset", true, doc.RootElement()->FirstChildElement( b ) == doc.RootElement()->LastChildElement() );
+
+		// many names grow the table
+		XMLDocument many;
+		XMLElement* root = many.NewElement( "root" );
+		many.InsertEndChild( root );
+		for ( int i = 0; i < 200; ++i ) {
+			char name[20] = "n";
+			XMLUtil::ToStr( i, name + 1, sizeof( name ) - 1 );
+			root->InsertEndChild( many.NewElement( name ) )->ToElement()->SetAttribute( "i", i );
+		}
+		XMLTest( "Many interned names", 137, root->FirstChildElement( many.Intern( "n137" ) )->IntAttribute( "i" ) );
+		XMLTest( "Many found names", 199, root->FirstChildElement( many.FindName( "n199" ) )->IntAttribute( "i" ) );
+	}
 
 
 	{
@@ -1562,6 +1791,30 @@ int main( int argc, const char ** argv )
 			XMLTest( "QueryDoubleText", 1.2, doubleValue, false );
 		}
 
+		{
+			// the fast path has to give the same bits as sscanf
+			const char* texts[] = { "1.2", " -0.1", "+.5", "7.", "2.5e+3", "1E-5", "16777217", "0.30000001",
+			                        "123456789012345678901", "1e40", "1e-40", "0x1p3", "inf", "1.5abc" };
+			bool same = true;
+			for ( size_t i = 0; i < sizeof( texts ) / sizeof( texts[0] ); ++i ) {
+				float fast = 0, slow = 0;
+				bool fastOk = XMLUtil::ToFloat( texts[i], &fast );
+				bool slowOk = sscanf( texts[i], "%f", &slow ) == 1;
+				same = same && fastOk == slowOk && memcmp( &fast, &slow, sizeof( fast ) ) == 0;
+			}
+			XMLTest( "ToFloat matches sscanf", true, same );
+		}
+
+		{
+			XMLDocument listDoc;
+			listDoc.Parse( "<splits><s>1.5</s><s> 4</s><s>7.25</s><s>x</s><s>9</s></splits>" );
+			float values[8] = { 0 };
+			int count = listDoc.RootElement()->QueryFloatChildTexts( values, 8 );
+			XMLTest( "QueryFloatChildTexts count", 3, count );
+			XMLTest( "QueryFloatChildTexts", 7.25f, values[2] );
+			XMLTest( "QueryFloatChildTexts maxCount", 2, listDoc.RootElement()->QueryFloatChildTexts( values, 2 ) );
+		}
+
 		{
 			bool boolValue = false;
 			XMLError queryResult = pointElement->FirstChildElement( "valid" )->QueryBoolText( &boolValue );
@@ -2280,6 +2533,257 @@ int main( int argc, const char ** argv )
     	doc.PrintError();
     }
 
+	// ----------- Layout ----------
+	{
+		// a range taken from a GroupMap keeps its end when pairs are added
+		// under uids after it, in empty slots between and past the last one
+		Layout::GroupMap groups;
+		groups.insert(std::make_pair(1u, Layout::GroupPair()));
+		groups.insert(std::make_pair(1u, Layout::GroupPair()));
+		groups.insert(std::make_pair(4u, Layout::GroupPair()));
+		Layout::GroupMapIt range { groups.equal_range(1)};
+		groups.insert(std::make_pair(2u, Layout::GroupPair()));
+		groups.insert(std::make_pair(9u, Layout::GroupPair()));
+		XMLTest( "GroupMap range after inserts", 2, static_cast<int>(std::distance(range.first, range.second)) );
+		range = groups.equal_range(4);
+		groups.insert(std::make_pair(5u, Layout::GroupPair()));
+		XMLTest( "GroupMap last range after inserts", 1, static_cast<int>(std::distance(range.first, range.second)) );
+		range = groups.equal_range(1);
+		range.first = groups.erase(range.first);
+		XMLTest( "GroupMap range after erase", 1, static_cast<int>(std::distance(range.first, range.second)) );
+		XMLTest( "GroupMap range of an empty slot", true, groups.equal_range(3).first == groups.end() );
+		unsigned previous {0};
+		bool ordered {true};
+		for (const Layout::GroupMap::value_type& entry : groups)
+		{
+			ordered = ordered && entry.first >= previous;
+			previous = entry.first;
+		}
+		XMLTest( "GroupMap walks uids in order", true, ordered );
+		XMLTest( "GroupMap size", 5, static_cast<int>(std::distance(groups.begin(), groups.end())) );
+	}
+
+	{
+		// banana: a = 0, b = 1, n = 2
+		const std::vector<unsigned> banana {1, 0, 2, 0, 2, 0};
+		const std::vector<unsigned> sa { Layout::suffixArray(banana)};
+		XMLTest( "suffixArray of banana", true, sa == std::vector<unsigned>{5, 3, 1, 0, 4, 2} );
+		XMLTest( "lcpArray of banana", true, Layout::lcpArray(banana, sa) == std::vector<unsigned>{0, 1, 3, 0, 0, 2} );
+		// ana overlaps itself; na always follows an a so it is not maximal
+		XMLTest( "maximalRepeats of banana", "3:1,3 1:1,3,5", runsText(Layout::maximalRepeats(banana, 1)).c_str() );
+		XMLTest( "maximalRepeats of banana, 2 or more", "3:1,3", runsText(Layout::maximalRepeats(banana, 2)).c_str() );
+		// a run at the start of the text is left maximal
+		const std::vector<unsigned> aaaa {0, 0, 0, 0};
+		XMLTest( "maximalRepeats of aaaa", "3:0,1 2:0,1,2 1:0,1,2,3", runsText(Layout::maximalRepeats(aaaa, 1)).c_str() );
+		// rows abc, abc and ab, each ended by a separator used once
+		const std::vector<unsigned> rows {0, 1, 2, 10, 0, 1, 2, 11, 0, 1, 12};
+		XMLTest( "maximalRepeats stop at separators", "3:0,4 2:0,4,8", runsText(Layout::maximalRepeats(rows, 2)).c_str() );
+		XMLTest( "maximalRepeats of a text without repeats", "", runsText(Layout::maximalRepeats(std::vector<unsigned>{0, 1, 2, 3}, 1)).c_str() );
+	}
+	{
+		// two equal rows of labels abcabc with equal column widths: the rows
+		// repeat as abcabc twice and abc four times, the columns as aa, bb
+		// and cc twice each
+		Layout::SyntheticFacade params;
+		params.rows = 2;
+		params.cols = 6;
+		params.tileRows = 1;
+		params.tileCols = 3;
+		Layout::writeSyntheticFacade(params, "resources/out/runs.xml");
+		Layout::BottomUp bu("resources/out/runs.xml", 0);
+		XMLTest( "addRepeatedRuns groups", 12, static_cast<int>(bu.addRepeatedRuns(2)) );
+		XMLTest( "addRepeatedRuns runs along X", 2, countNames(bu.names, "Run X :") );
+		XMLTest( "addRepeatedRuns runs along Y", 3, countNames(bu.names, "Run Y :") );
+		XMLTest( "addRepeatedRuns again adds nothing", 0, static_cast<int>(bu.addRepeatedRuns(2)) );
+		Layout::BottomUp longer("resources/out/runs.xml", 0);
+		XMLTest( "addRepeatedRuns of 4 or more", 2, static_cast<int>(longer.addRepeatedRuns(4)) );
+	}
+
+	{
+		// rows 1 2 1 2 and 3 4 3 4; a block wider than two cells never repeats
+		const std::vector<unsigned> grid {1, 2, 1, 2, 3, 4, 3, 4};
+		const char* expected = "1x2:(0,0)(0,2) 1x2:(1,0)(1,2) 2x1:(0,0)(0,2) 2x1:(0,1)(0,3) 2x2:(0,0)(0,2)";
+		XMLTest( "repeatedTiles of a 2 x 4 grid", expected, tilesText(Layout::repeatedTiles(grid, 2, 4)).c_str() );
+		XMLTest( "repeatedTiles with colliding hashes", expected,
+				tilesText(Layout::repeatedTiles(grid, 2, 4, collidingHash)).c_str() );
+		// holes 10 and 11 are symbols of their own, so no 2 x 2 block repeats
+		const std::vector<unsigned> holes {1, 2, 1, 2, 3, 10, 3, 11};
+		XMLTest( "repeatedTiles around holes", "1x2:(0,0)(0,2) 2x1:(0,0)(0,2)",
+				tilesText(Layout::repeatedTiles(holes, 2, 4)).c_str() );
+		XMLTest( "repeatedTiles of a grid without repeats", "",
+				tilesText(Layout::repeatedTiles(std::vector<unsigned>{1, 2, 3, 4}, 2, 2)).c_str() );
+		// a bigger grid with a few labels: collisions everywhere change nothing
+		std::vector<unsigned> mixed;
+		for (unsigned i = 0; i < 12 * 9; ++i)
+			mixed.push_back((i * 7 + i / 9) % 5);
+		XMLTest( "repeatedTiles of a 12 x 9 grid with colliding hashes", true,
+				tilesText(Layout::repeatedTiles(mixed, 12, 9)) == tilesText(Layout::repeatedTiles(mixed, 12, 9, collidingHash)) );
+	}
+	{
+		// 2 x 3 tiles of labels: the taller tiles are made of the one row
+		// tiles at their corners
+		Layout::SyntheticFacade params;
+		params.rows = 4;
+		params.cols = 6;
+		Layout::writeSyntheticFacade(params, "resources/out/tiles.xml");
+		Layout::BottomUp bu("resources/out/tiles.xml", 0);
+		bool thrown = false;
+		unsigned added = 0;
+		try {
+			added = bu.addRepeatedTiles();
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		XMLTest( "addRepeatedTiles finds every row of its tiles", false, thrown );
+		int tall = 0;
+		XMLTest( "addRepeatedTiles tiles are rows of cells", true, tilesAreRowsOfCells(bu, tall) );
+		XMLTest( "addRepeatedTiles adds tiles of rows", true, added > 0 && tall > 0 );
+		XMLTest( "addRepeatedTiles again adds nothing", 0, static_cast<int>(bu.addRepeatedTiles()) );
+
+		// eight terminals of Layout span several cells and are holes
+		Layout::BottomUp layout("resources/Layout.xml", 0);
+		layout.addRepeatedTiles();
+		XMLTest( "addRepeatedTiles of Layout skips cells of wide terminals", true, tilesAreRowsOfCells(layout, tall) );
+	}
+
+	{
+		// a frozen BottomUp has the groups and names it was given, whether
+		// built part of the way or with tiles
+		std::unique_ptr<Layout::BottomUp> partial(new Layout::BottomUp("resources/LayoutCut.xml", 2));
+		Layout::FrozenBottomUp frozenPartial(std::unique_ptr<Layout::BottomUp>(new Layout::BottomUp("resources/LayoutCut.xml", 2)));
+		XMLTest( "FrozenBottomUp keeps the groups of a partial build", true, sameGroups(partial->groups, frozenPartial.groups()) );
+		XMLTest( "FrozenBottomUp keeps the names of a partial build", true, partial->names == frozenPartial.names() );
+		std::unique_ptr<Layout::BottomUp> tiled(new Layout::BottomUp("resources/LayoutCut.xml", 0));
+		tiled->addRepeatedTiles();
+		std::unique_ptr<Layout::BottomUp> toFreeze(new Layout::BottomUp("resources/LayoutCut.xml", 0));
+		toFreeze->addRepeatedTiles();
+		Layout::FrozenBottomUp frozenTiles(std::move(toFreeze));
+		XMLTest( "FrozenBottomUp keeps the groups of tiles", true, sameGroups(tiled->groups, frozenTiles.groups()) );
+		XMLTest( "FrozenBottomUp keeps the names of tiles", true, tiled->names == frozenTiles.names() );
+
+		// the cost of every split line is that of allSplitGroups, also
+		// when two threads ask at once
+		Layout::FrozenBottomUp frozen(std::unique_ptr<Layout::BottomUp>(new Layout::BottomUp("resources/Layout.xml")));
+		std::vector<std::pair<Layout::GroupPair, Layout::SplitIt>> lines;
+		collectSplitLines(frozen.location(), lines);
+		std::vector<Layout::NodeMap::size_type> serial(lines.size()), parallel(lines.size());
+		bool same = !lines.empty();
+		for (std::vector<Layout::NodeMap::size_type>::size_type i = 0; i < lines.size(); ++i)
+		{
+			Layout::LineSegment line(lines[i].first, lines[i].second);
+			Layout::LineSegment copy(lines[i].first, lines[i].second);
+			serial[i] = frozen.splitCost(lines[i].first, line);
+			same = same && serial[i] == Layout::allSplitGroups(lines[i].first, copy).size();
+		}
+		XMLTest( "FrozenBottomUp splitCost is the size of allSplitGroups", true, same );
+		std::vector<std::thread> pool;
+		for (unsigned t = 0; t < 2; ++t)
+			pool.push_back(std::thread([&frozen, &lines, &parallel, t]()
+				{
+					for (std::vector<Layout::NodeMap::size_type>::size_type i = t; i < lines.size(); i += 2)
+					{
+						Layout::LineSegment line(lines[i].first, lines[i].second);
+						parallel[i] = frozen.splitCost(lines[i].first, line);
+					}
+				}));
+		for (std::thread& thread : pool)
+			thread.join();
+		XMLTest( "FrozenBottomUp splitCost on two threads", true, serial == parallel );
+	}
+
+	{
+		// the batch kernels give the bits of the Efloat operators, also
+		// for the elements past the last full vector
+		std::mt19937 gen(660);
+		std::uniform_real_distribution<float> dist(0.01f, 1.f);
+		std::vector<Efloat> a, b, out;
+		for (int i = 0; i < 1003; ++i) {
+			a.push_back(Layout::ScalarInput<Efloat>::read(dist(gen)));
+			b.push_back(Layout::ScalarInput<Efloat>::read(dist(gen)));
+		}
+		Layout::IntervalBatch ab(a), bb(b), ob;
+		Layout::add(ab, bb, ob);
+		for (std::vector<Efloat>::size_type i = 0; i < a.size(); ++i)
+			out.push_back(a[i] + b[i]);
+		XMLTest( "IntervalBatch add", true, sameBits(ob, out) );
+		Layout::subtract(ab, bb, ob);
+		for (std::vector<Efloat>::size_type i = 0; i < a.size(); ++i)
+			out[i] = a[i] - b[i];
+		XMLTest( "IntervalBatch subtract", true, sameBits(ob, out) );
+		Layout::multiply(ab, bb, ob);
+		for (std::vector<Efloat>::size_type i = 0; i < a.size(); ++i)
+			out[i] = a[i] * b[i];
+		XMLTest( "IntervalBatch multiply", true, sameBits(ob, out) );
+		// the corners of the children from a corner and sorted splits
+		std::vector<Efloat> splits;
+		Efloat at;
+		for (std::vector<Efloat>::size_type i = 0; i < a.size(); ++i) {
+			at = at + a[i];
+			splits.push_back(at);
+		}
+		Efloat corner = Layout::ScalarInput<Efloat>::read(3.f);
+		Layout::offset(corner, Layout::IntervalBatch(splits), ob);
+		for (std::vector<Efloat>::size_type i = 0; i < splits.size(); ++i)
+			out[i] = corner + splits[i];
+		XMLTest( "IntervalBatch offset", true, sameBits(ob, out) );
+
+		// countNotAbove is upper_bound for splits further apart than their errors
+		splits.resize(21);
+		std::vector<float> lows;
+		for (const Efloat& split : splits)
+			lows.push_back(split.lowerBound());
+		bool same = true;
+		for (int i = 0; i < 200; ++i) {
+			Efloat x(dist(gen) * float(splits.back()) * 1.1f);
+			same = same && Layout::countNotAbove(lows, x) ==
+				static_cast<std::size_t>(std::upper_bound(splits.cbegin(), splits.cend(), x) - splits.cbegin());
+		}
+		XMLTest( "countNotAbove is upper_bound", true, same );
+
+		// exact splits have bounds narrower than the error the kernels
+		// would give them; look just below each
+		std::vector<Efloat> exact;
+		for (float f : {0.25f, 0.5f, 1.f, 2.f, 4.f})
+			exact.push_back(Efloat(f, Efloat::PowerOf2));
+		Layout::SplitIndex<Efloat> index(exact);
+		same = true;
+		for (const Efloat& split : exact) {
+			float v = float(split);
+			for (int step = 0; step < 16; ++step) {
+				Efloat x(v);
+				same = same && index.upperBound(exact, x) ==
+					static_cast<std::size_t>(std::upper_bound(exact.cbegin(), exact.cend(), x) - exact.cbegin());
+				v = std::nextafter(v, 0.f);
+			}
+		}
+		XMLTest( "SplitIndex is upper_bound just below exact splits", true, same );
+	}
+
+	{
+		// the location tree read on several threads is the one read on one
+		Layout::SyntheticFacade nested;
+		nested.rows = 6;
+		nested.cols = 8;
+		nested.depth = 2;
+		Layout::writeSyntheticFacade(nested, "resources/out/nested.xml");
+		const char* files[] = {"resources/Layout.xml", "resources/NR07031_basic.xml", "resources/out/nested.xml"};
+		tinyxml2::XMLDocument doc;
+		for (const char* file : files) {
+			for (unsigned maxTerms : {0u, 1000u}) {
+				Layout::BottomUp serial(file, maxTerms, doc, 1);
+				bool same = true;
+				for (unsigned threads : {2u, 3u, 0u}) {
+					Layout::BottomUp parallel(file, maxTerms, doc, threads);
+					same = same && serial.names == parallel.names && sameGroups(serial.groups, parallel.groups) &&
+						sameTree(*serial.location.first, *parallel.location.first);
+				}
+				std::string name = std::string("BottomUp of ") + file + (maxTerms == 0 ? " terminals" : "") + " on 2, 3 and all threads";
+				XMLTest( name.c_str(), true, same );
+			}
+		}
+	}
+
     // ----------- Performance tracking --------------
 	{
 #if defined( _MSC_VER )